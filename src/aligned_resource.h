@@ -0,0 +1,93 @@
+#ifndef B_ALIGNEDRESOURCE_H
+#define B_ALIGNEDRESOURCE_H
+
+#include <cstddef>
+#include <new>
+#include <algorithm>
+#include <memory_resource>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "config.h"
+
+namespace ByteE
+{
+	class AlignedResource : public MemoryResource
+	{
+	public:
+		inline static constexpr size_t CACHE_LINE{ 64 };
+		inline static constexpr size_t HUGE_PAGE{ 2ULL << 20 };
+
+	private:
+		size_t alignment;
+		size_t hugePageThreshold;
+
+	public:
+		AlignedResource(size_t alignment = CACHE_LINE, size_t hugePageThreshold = HUGE_PAGE)
+			:alignment{ alignment }, hugePageThreshold{ hugePageThreshold }
+		{
+		}
+
+		size_t getAlignment() const
+		{
+			return alignment;
+		}
+
+		size_t getHugePageThreshold() const
+		{
+			return hugePageThreshold;
+		}
+
+	private:
+		void* do_allocate(size_t bytes, size_t align) override
+		{
+			size_t blockAlignment{ getBlockAlignment(bytes, align) };
+			size_t blockSize{ getBlockSize(bytes, blockAlignment) };
+			void* block{ ::operator new(blockSize, std::align_val_t{ blockAlignment }) };
+
+#ifdef __linux__
+			if (usesHugePages(bytes))
+			{
+				madvise(block, blockSize, MADV_HUGEPAGE);
+			}
+#endif
+
+			return block;
+		}
+
+		void do_deallocate(void* block, size_t bytes, size_t align) override
+		{
+			size_t blockAlignment{ getBlockAlignment(bytes, align) };
+			::operator delete(block, getBlockSize(bytes, blockAlignment), std::align_val_t{ blockAlignment });
+		}
+
+		bool do_is_equal(const MemoryResource& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+		bool usesHugePages(size_t bytes) const
+		{
+			return hugePageThreshold && bytes >= hugePageThreshold;
+		}
+
+		size_t getBlockAlignment(size_t bytes, size_t align) const
+		{
+			size_t out{ std::max(align, alignment) };
+			if (usesHugePages(bytes))
+			{
+				out = std::max(out, HUGE_PAGE);
+			}
+			return out;
+		}
+
+		static size_t getBlockSize(size_t bytes, size_t blockAlignment)
+		{
+			return (bytes + blockAlignment - 1) & ~(blockAlignment - 1);
+		}
+	};
+}
+
+#endif
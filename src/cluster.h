@@ -3,34 +3,125 @@
 
 #include <type_traits>
 #include <tuple>
+#include <array>
+#include <utility>
+#include <algorithm>
 #include <vector>
 #include <memory>
 
 #include "stair_map.h"
+#include "flat_map.h"
 #include "component.h"
 #include "component_vector.h"
 #include "signature.h"
+#include "signature_registry.h"
+#include "sparse_set.h"
 
 #include "config.h"
 
 namespace ByteE
 {
+	template<typename Type>
+	struct Changed
+	{
+	};
+
+	template<typename Type>
+	struct QueryTraits
+	{
+		using Component = Type;
+		using Value = Type;
+
+		inline static constexpr bool CHANGED{ false };
+		inline static constexpr bool MUTABLE{ true };
+		inline static constexpr bool SPARSE{ ComponentStorage<Type>::SPARSE };
+		inline static constexpr bool TAG{ StorageTraits<Type>::TAG };
+		inline static constexpr bool COLUMN{ !SPARSE && !TAG };
+		inline static constexpr bool ROW_TICKS{ ChangeTracking<Type>::ROW_TICKS && COLUMN };
+	};
+
+	template<typename Type>
+	struct QueryTraits<const Type>
+	{
+		using Component = Type;
+		using Value = const Type;
+
+		inline static constexpr bool CHANGED{ false };
+		inline static constexpr bool MUTABLE{ false };
+		inline static constexpr bool SPARSE{ ComponentStorage<Type>::SPARSE };
+		inline static constexpr bool TAG{ StorageTraits<Type>::TAG };
+		inline static constexpr bool COLUMN{ !SPARSE && !TAG };
+		inline static constexpr bool ROW_TICKS{ ChangeTracking<Type>::ROW_TICKS && COLUMN };
+	};
+
+	template<typename Type>
+	struct QueryTraits<Changed<Type>>
+	{
+		using Component = Type;
+		using Value = const Type;
+
+		inline static constexpr bool CHANGED{ true };
+		inline static constexpr bool MUTABLE{ false };
+		inline static constexpr bool SPARSE{ ComponentStorage<Type>::SPARSE };
+		inline static constexpr bool TAG{ StorageTraits<Type>::TAG };
+		inline static constexpr bool COLUMN{ !SPARSE && !TAG };
+		inline static constexpr bool ROW_TICKS{ ChangeTracking<Type>::ROW_TICKS };
+
+		static_assert(COLUMN, "only column components record change ticks");
+	};
+
 	template<typename... Types>
-	using ComponentGroup = std::tuple<EntityID, Types&...>;
+	using ComponentGroup = std::tuple<EntityID, typename QueryTraits<Types>::Value&...>;
+
+	class Cluster;
+
+	struct ColumnLink
+	{
+		ComponentID component;
+		IComponentVector* source;
+		IComponentVector* destination;
+	};
+
+	struct Column
+	{
+		ComponentID component;
+		ComponentVectorBase vector;
+	};
+
+	struct ClusterEdge
+	{
+		using LinkContainer = std::vector<ColumnLink, Allocator<ColumnLink>>;
+
+		Cluster* destination{ nullptr };
+		LinkContainer links;
+	};
 
 	class Cluster
 	{
 	public:
-		using Container = ByteC::StairMap<ComponentID, ComponentVectorBase>;
-		using IndexContainer = ByteC::StairMap<EntityID, Index>;
-		using IDContainer = ByteC::StairVector<EntityID>;
+		using Slot = uint16_t;
+		using ArrayTicks = std::array<Tick, ByteC::ArrayContainer<EntityID>::MAX_ARRAYS>;
+		using Container = std::vector<Column, Allocator<Column>>;
+		using SlotContainer = std::vector<Slot, Allocator<Slot>>;
+		using IDContainer = ByteC::StairVector<EntityID, Allocator<EntityID>>;
+		using EdgeContainer = ByteC::FlatMap<
+			ComponentID,
+			ClusterEdge,
+			ByteA::Hash<ComponentID>,
+			Allocator<ByteC::FlatNode<ComponentID, ClusterEdge>>>;
+
+		inline static constexpr Slot NO_SLOT{ UINT16_MAX };
 
 	private:
 		ClusterID id;
-		Signature signature;
-		Container components;
-		IndexContainer indices;
+		const SignatureEntry* signature;
+		Container columns;
+		SlotContainer slots;
 		IDContainer ids;
+		EdgeContainer edges;
+		const Tick* clock;
+		ArrayTicks arrayTicks{};
+		uint64_t version{};
 
 		friend struct ClusterTraits;
 
@@ -44,50 +135,410 @@ namespace ByteE
 			using MapPointer = IDContainer*;
 			using ComponentGroup = ComponentGroup<Types...>;
 
+			inline static constexpr bool SPARSE{ (QueryTraits<Types>::SPARSE || ...) };
+			inline static constexpr bool MUTABLE{ ((QueryTraits<Types>::MUTABLE && QueryTraits<Types>::COLUMN) || ...) };
+			inline static constexpr bool ROW_FILTER{ ((QueryTraits<Types>::CHANGED && QueryTraits<Types>::ROW_TICKS) || ...) || SPARSE };
+
+			using RowTicks = std::array<const Tick*, sizeof...(Types)>;
+			using SparseSets = std::array<ISparseSet*, sizeof...(Types)>;
+
 		private:
 			Container components;
-			MapPointer ids;
+			MapPointer ids{ nullptr };
+			const Tick* clusterTicks{ nullptr };
+			Tick since{};
+			SparseSets sets{};
+			SparseGroup excluded;
+			bool filterRows{ ROW_FILTER };
+			bool filterEntities{ SPARSE };
 
 		public:
 			Cache() = default;
 
-			Cache(Cluster& cluster)
-				:ids{&cluster.ids}
+			Cache(Cluster& cluster, Tick since = nullTick, const SparseContainer* sparse = nullptr, const SparseGroup& excluded = {})
+				:ids{&cluster.ids}, clusterTicks{ cluster.arrayTicks.data() }, since{ since }, excluded{ excluded }, 
+				filterRows{ ROW_FILTER || !excluded.empty() }, 
+				filterEntities{ SPARSE || !excluded.empty() }
 			{
-				((components.push_back(cluster.components.at(Component<Types>::getID()).get())),...);
+				((components.push_back(cluster.getColumn(Component<typename QueryTraits<Types>::Component>::getID()))),...);
+
+				if constexpr (SPARSE)
+				{
+					if (!bindSets(sparse, std::index_sequence_for<Types...>{}))
+					{
+						ids = nullptr;
+					}
+				}
 			}
 
 			ComponentGroup getComponents(Index index)
 			{
-				return ComponentGroup(ids->at(index),(getComponent<Types>(index))...);
+				return getComponents(index, std::index_sequence_for<Types...>{});
 			}
 
 			size_t size() const
 			{
-				if (components.empty())
+				if (!ids)
 				{
 					return 0;
 				}
-				return components[0]->size();
+				return ids->size();
+			}
+
+			bool changed(size_t array) const
+			{
+				return changed(array, std::index_sequence_for<Types...>{});
+			}
+
+			void touch()
+			{
+				if (!MUTABLE || size() == 0)
+				{
+					return;
+				}
+
+				size_t arrayCount{ ByteC::getArrayIndex(size() - 1) + 1 };
+				for (size_t array{}; array < arrayCount; ++array)
+				{
+					if (changed(array))
+					{
+						touch(array, std::index_sequence_for<Types...>{});
+					}
+				}
+			}
+
+			template<typename Function>
+			void forEachChunk(Function& function)
+			{
+				touch();
+				forEachChunk(function, 0, size(), std::index_sequence_for<Types...>{});
+			}
+
+			template<typename Function>
+			void forEachChunk(Function& function, size_t first, size_t last)
+			{
+				forEachChunk(function, first, last, std::index_sequence_for<Types...>{});
+			}
+
+			template<typename Function>
+			void forEach(Function& function, size_t first, size_t last)
+			{
+				forEach(function, first, last, std::index_sequence_for<Types...>{});
+			}
+
+			bool seekRun(size_t& first, size_t& last, size_t end)
+			{
+				while (first < end)
+				{
+					size_t array{ ByteC::getArrayIndex(first) };
+					size_t base{ ByteC::getArraySize(array) - 2 };
+					size_t arrayEnd{ std::min(2 * ByteC::getArraySize(array) - 2, end) };
+
+					if (changed(array))
+					{
+						if (filterRows)
+						{
+							RowTicks ticks{ getRowTicks(array, std::index_sequence_for<Types...>{}) };
+							const EntityID* rowIDs{ ids->data().at(array) };
+
+							while (first < arrayEnd && !rowMatch(ticks, rowIDs, first - base))
+							{
+								++first;
+							}
+
+							last = first;
+							while (last < arrayEnd && rowMatch(ticks, rowIDs, last - base))
+							{
+								++last;
+							}
+						}
+						else
+						{
+							last = arrayEnd;
+						}
+
+						if (first < last)
+						{
+							markRun(first, last - first, std::index_sequence_for<Types...>{});
+							return true;
+						}
+					}
+
+					first = arrayEnd;
+				}
+				return false;
 			}
 
 		private:
+			template<typename Function, size_t... Indices>
+			void forEachChunk(Function& function, size_t first, size_t last, std::index_sequence<Indices...>)
+			{
+				static_assert(!SPARSE, "sparse components are not stored in chunks");
+
+				size_t runEnd{};
+				while (seekRun(first, runEnd, last))
+				{
+					size_t array{ ByteC::getArrayIndex(first) };
+					size_t offset{ first + 2 - ByteC::getArraySize(array) };
+
+					std::apply([&function, count{ runEnd - first }, rowIDs{ ids->data().at(array) + offset }](auto*... arrays)
+					{
+						function(count, rowIDs, arrays...);
+					}, std::tuple_cat(getChunk<Types>(Indices, array, offset)...));
+
+					first = runEnd;
+				}
+			}
+
+			template<typename Function, size_t... Indices>
+			void forEach(Function& function, size_t first, size_t last, std::index_sequence<Indices...>)
+			{
+				static_assert(!SPARSE, "sparse components are not stored in chunks");
+
+				size_t runEnd{};
+				while (seekRun(first, runEnd, last))
+				{
+					size_t array{ ByteC::getArrayIndex(first) };
+					size_t offset{ first + 2 - ByteC::getArraySize(array) };
+					const EntityID* rowIDs{ ids->data().at(array) + offset };
+					std::tuple<typename QueryTraits<Types>::Value*...> rows{ getRows<Types>(Indices, array, offset)... };
+
+					for (size_t index{}; index < runEnd - first; ++index)
+					{
+						function(rowIDs[index], getRow<Types>(std::get<Indices>(rows), index)...);
+					}
+
+					first = runEnd;
+				}
+			}
+
+			template<size_t... Indices>
+			bool bindSets(const SparseContainer* sparse, std::index_sequence<Indices...>)
+			{
+				return (bindSet<Types>(sparse, Indices) && ...);
+			}
+
+			template<typename Type>
+			bool bindSet(const SparseContainer* sparse, size_t column)
+			{
+				if constexpr (QueryTraits<Type>::SPARSE)
+				{
+					sets[column] = sparse ? sparse->findSet(Component<typename QueryTraits<Type>::Component>::getID()) : nullptr;
+					return sets[column] != nullptr;
+				}
+				else
+				{
+					return true;
+				}
+			}
+
+			bool rowMatch(const RowTicks& ticks, const EntityID* rowIDs, size_t offset) const
+			{
+				return rowChanged(ticks, offset, std::index_sequence_for<Types...>{}) && 
+					(!filterEntities || rowSparse(rowIDs[offset], std::index_sequence_for<Types...>{}));
+			}
+
+			template<size_t... Indices>
+			bool rowSparse(EntityID id, std::index_sequence<Indices...>) const
+			{
+				if constexpr (SPARSE)
+				{
+					if (!((!QueryTraits<Types>::SPARSE || sets[Indices]->contains(id)) && ...))
+					{
+						return false;
+					}
+				}
+
+				for (const ISparseSet* set : excluded)
+				{
+					if (set->contains(id))
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+
+			template<size_t... Indices>
+			RowTicks getRowTicks(size_t array, std::index_sequence<Indices...>) const
+			{
+				return RowTicks{ getRowTicks<Types>(Indices, array)... };
+			}
+
+			template<typename Type>
+			const Tick* getRowTicks(size_t column, size_t array) const
+			{
+				if constexpr (QueryTraits<Type>::COLUMN)
+				{
+					return getVector<Type>(column)->getRowTicks(array);
+				}
+				else
+				{
+					return nullptr;
+				}
+			}
+
+			template<size_t... Indices>
+			bool rowChanged(const RowTicks& ticks, size_t offset, std::index_sequence<Indices...>) const
+			{
+				return (rowChanged<Types>(ticks[Indices], offset) && ...);
+			}
+
+			template<typename Type>
+			bool rowChanged(const Tick* ticks, size_t offset) const
+			{
+				if constexpr (QueryTraits<Type>::CHANGED && QueryTraits<Type>::ROW_TICKS)
+				{
+					return ticks[offset] > since;
+				}
+				else
+				{
+					return true;
+				}
+			}
+
+			template<size_t... Indices>
+			void markRun(size_t first, size_t count, std::index_sequence<Indices...>)
+			{
+				(markRun<Types>(Indices, first, count), ...);
+			}
+
+			template<typename Type>
+			void markRun(size_t column, size_t first, size_t count)
+			{
+				if constexpr (QueryTraits<Type>::MUTABLE && QueryTraits<Type>::ROW_TICKS)
+				{
+					getVector<Type>(column)->markRun(first, count);
+				}
+			}
+
+			template<size_t... Indices>
+			bool changed(size_t array, std::index_sequence<Indices...>) const
+			{
+				return (changed<Types>(Indices, array) && ...);
+			}
+
+			template<typename Type>
+			bool changed(size_t column, size_t array) const
+			{
+				if constexpr (QueryTraits<Type>::CHANGED)
+				{
+					return std::max(getVector<Type>(column)->getArrayTick(array), clusterTicks[array]) > since;
+				}
+				else
+				{
+					return true;
+				}
+			}
+
+			template<size_t... Indices>
+			void touch(size_t array, std::index_sequence<Indices...>)
+			{
+				(touch<Types>(Indices, array), ...);
+			}
+
+			template<typename Type>
+			void touch(size_t column, size_t array)
+			{
+				if constexpr (QueryTraits<Type>::MUTABLE && QueryTraits<Type>::COLUMN)
+				{
+					getVector<Type>(column)->markArray(array);
+				}
+			}
+
+			template<typename Type>
+			ComponentVector<typename QueryTraits<Type>::Component>* getVector(size_t column) const
+			{
+				return static_cast<ComponentVector<typename QueryTraits<Type>::Component>*>(components[column]);
+			}
+
+			template<typename Type>
+			typename QueryTraits<Type>::Value* getArray(size_t column, size_t array)
+			{
+				return getVector<Type>(column)->data().at(array);
+			}
+
+			template<typename Type>
+			auto getChunk(size_t column, size_t array, size_t offset)
+			{
+				if constexpr (QueryTraits<Type>::TAG)
+				{
+					return std::tuple<>{};
+				}
+				else
+				{
+					return std::tuple<typename QueryTraits<Type>::Value*>{ getArray<Type>(column, array) + offset };
+				}
+			}
+
 			template<typename Type>
-			Type& getComponent(Index index)
+			typename QueryTraits<Type>::Value* getRows(size_t column, size_t array, size_t offset)
 			{
-				return static_cast<ComponentVector<Type>*>(components[Component<Type>::getID()])->at(index);
+				if constexpr (QueryTraits<Type>::TAG)
+				{
+					return &StorageTraits<Type>::getTag();
+				}
+				else
+				{
+					return getArray<Type>(column, array) + offset;
+				}
+			}
+
+			template<typename Type>
+			static typename QueryTraits<Type>::Value& getRow(typename QueryTraits<Type>::Value* rows, size_t index)
+			{
+				if constexpr (QueryTraits<Type>::TAG)
+				{
+					return *rows;
+				}
+				else
+				{
+					return rows[index];
+				}
+			}
+
+			template<size_t... Indices>
+			ComponentGroup getComponents(Index index, std::index_sequence<Indices...>)
+			{
+				return ComponentGroup(ids->at(index), (getComponent<Types>(Indices, index))...);
+			}
+
+			template<typename Type>
+			typename QueryTraits<Type>::Value& getComponent(size_t column, Index index)
+			{
+				if constexpr (QueryTraits<Type>::SPARSE)
+				{
+					return static_cast<SparseSet<typename QueryTraits<Type>::Component>*>(sets[column])->get(ids->at(index));
+				}
+				else if constexpr (QueryTraits<Type>::TAG)
+				{
+					return StorageTraits<Type>::getTag();
+				}
+				else
+				{
+					return getVector<Type>(column)->at(index);
+				}
 			}
 		};
 
 	public:
-		Cluster(ClusterID id, const Signature& signature)
-			:id{ id }, signature{signature}
+		Cluster(
+			ClusterID id, 
+			const SignatureEntry& signature, 
+			MemoryResource* resource = std::pmr::get_default_resource(), 
+			const Tick* clock = &nullTick)
+			:id{ id }, signature{ &signature }, columns{ resource }, slots{ resource }, ids{ resource }, edges{ resource }, clock{ clock }
 		{
-			const auto& componentList{ signature.query() };
+			const auto& componentList{ signature.components };
+			columns.reserve(componentList.size());
 
 			for (ComponentID id : componentList)
 			{
-				components.insert(id, ComponentAccessor::createArray(id));
+				ComponentVectorBase column{ ComponentAccessor::createArray(id, resource, clock) };
+				if (column)
+				{
+					insertColumn(id, std::move(column));
+				}
 			}
 		}
 
@@ -96,68 +547,204 @@ namespace ByteE
 			return id;
 		}
 
-		const Signature& getSignature()
+		MemoryResource* getResource() const
+		{
+			return ids.getAllocator().resource();
+		}
+
+		const Tick* getClock() const
+		{
+			return clock;
+		}
+
+		const Signature& getSignature() const
+		{
+			return signature->signature;
+		}
+
+		SignatureID getSignatureID() const
 		{
-			return signature;
+			return signature->id;
 		}
 
-		void pushEntity(EntityID id)
+		const SignatureEntry::ComponentList& getComponentIDs() const
+		{
+			return signature->components;
+		}
+
+		void setSignature(const SignatureEntry& newSignature)
+		{
+			signature = &newSignature;
+		}
+
+		Index pushEntity(EntityID id)
 		{
-			indices.insert(id, static_cast<Index>(ids.size()));
 			ids.pushBack(id);
+			markArray(ByteC::getArrayIndex(ids.size() - 1));
+			return static_cast<Index>(ids.size() - 1);
+		}
+
+		Index pushEntities(const std::vector<EntityID>& newIDs)
+		{
+			Index firstRow{ static_cast<Index>(ids.size()) };
+			ids.increaseCapacity(ids.size() + newIDs.size());
+
+			for (EntityID id : newIDs)
+			{
+				ids.pushBack(id);
+			}
+			markRows(firstRow, newIDs.size());
+
+			return firstRow;
 		}
 
-		void removeEntity(EntityID id)
+		[[nodiscard]] EntityID removeEntity(Index row)
 		{
-			EntityID lastEntity{ids.back()};
-			Index lastIndex{static_cast<Index>(ids.size() - 1)};
-			Index entityIndex{indices.at(id)};
+			Index lastRow{static_cast<Index>(ids.size() - 1)};
+			++version;
 
-			if (id != lastEntity)
+			if (row != lastRow)
 			{
-				for (auto& pair : components)
+				EntityID lastEntity{ids.back()};
+
+				for (Column& column : columns)
 				{
-					pair.second->swap(entityIndex, lastIndex);
-					pair.second->popBack();
+					column.vector->swapRemove(row);
 				}
 
-				indices[lastEntity] = entityIndex;
-				ids[entityIndex] = lastEntity;
+				ids[row] = lastEntity;
+				ids.popBack();
+				markArray(ByteC::getArrayIndex(row));
+
+				return lastEntity;
 			}
-			else
+
+			for (Column& column : columns)
+			{
+				column.vector->popBack();
+			}
+			ids.popBack();
+
+			return nullEntity;
+		}
+
+		void removeEntities(const Index* rows, size_t count)
+		{
+			++version;
+
+			for (Column& column : columns)
+			{
+				column.vector->swapRemove(rows, count);
+			}
+
+			size_t last{ ids.size() };
+			for (size_t index{}; index < count; ++index)
 			{
-				for (auto& pair : components)
+				--last;
+				if (rows[index] != last)
 				{
-					pair.second->popBack();
+					ids[rows[index]] = ids[last];
+					markArray(ByteC::getArrayIndex(rows[index]));
 				}
 			}
+			ids.popBack(count);
+		}
 
-			indices.erase(id);
-			ids.popBack();
+		EntityID getEntity(Index row) const
+		{
+			return ids.at(row);
+		}
+
+		const IDContainer& getEntities() const
+		{
+			return ids;
 		}
 
 		template<typename Type>
 		void pushComponent(Type&& component)
 		{
-			getVector<Type>().pushBack(std::move(component));
+			emplaceComponent<std::decay_t<Type>>(std::forward<Type>(component));
+		}
+
+		template<typename Type, typename... Args>
+		Type& emplaceComponent(Args&&... args)
+		{
+			if constexpr (StorageTraits<Type>::TAG)
+			{
+				return StorageTraits<Type>::getTag();
+			}
+			else
+			{
+				return getVector<Type>().emplaceBack(std::forward<Args>(args)...);
+			}
+		}
+
+		template<typename Type>
+		void pushComponents(size_t count, const Type& component)
+		{
+			if constexpr (!StorageTraits<Type>::TAG)
+			{
+				getVector<Type>().pushBack(count, component);
+			}
 		}
 
 		template<typename Type>
-		Type& getComponent(EntityID id)
+		Type& getComponent(Index row)
 		{
-			return getVector<Type>().at(indices.at(id));
+			if constexpr (StorageTraits<Type>::TAG)
+			{
+				return StorageTraits<Type>::getTag();
+			}
+			else
+			{
+				ComponentVector<Type>& vector{ getVector<Type>() };
+				vector.markChanged(row);
+				return vector.at(row);
+			}
 		}
 
 		template<typename Type>
-		const Type& getComponent(EntityID id) const
+		const Type& getComponent(Index row) const
+		{
+			if constexpr (StorageTraits<Type>::TAG)
+			{
+				return StorageTraits<Type>::getTag();
+			}
+			else
+			{
+				return getVector<Type>().at(row);
+			}
+		}
+
+		template<typename Type, typename... Args>
+		Type& assignComponent(Index row, Args&&... args)
 		{
-			return getVector<Type>().at(indices.at(id));
+			Type& out{ getComponent<Type>(row) };
+			if constexpr (sizeof...(Args) == 1 && (std::is_same_v<std::decay_t<Args>, Type> && ...))
+			{
+				((out = std::forward<Args>(args)), ...);
+			}
+			else
+			{
+				out = Type(std::forward<Args>(args)...);
+			}
+			return out;
 		}
 
 		template<typename Type>
-		void setComponent(EntityID id, Type&& component)
+		void setComponent(Index row, Type&& component)
 		{
-			getVector<Type>().at(indices.at(id)) = std::move(component);
+			getComponent<std::decay_t<Type>>(row) = std::forward<Type>(component);
+		}
+
+		IComponentVector* getColumn(ComponentID component)
+		{
+			Slot slot{ findSlot(component) };
+			if (slot != NO_SLOT)
+			{
+				return columns[slot].vector.get();
+			}
+			return nullptr;
 		}
 
 		size_t size() const
@@ -165,42 +752,241 @@ namespace ByteE
 			return ids.size();
 		}
 
+		uint64_t getVersion() const
+		{
+			return version;
+		}
+
+		size_t componentCount() const
+		{
+			return signature->components.size();
+		}
+
 		bool empty() const
 		{
 			return size() == 0;
 		}
 
+		ClusterEdge* findEdge(ComponentID component)
+		{
+			auto result{ edges.find(component) };
+			if (result.valid())
+			{
+				return &result.get();
+			}
+			return nullptr;
+		}
+
+		void setEdge(ComponentID component, Cluster& destination)
+		{
+			ClusterEdge edge{ &destination, ClusterEdge::LinkContainer{ getResource() } };
+			for (Column& column : columns)
+			{
+				IComponentVector* destinationColumn{ destination.getColumn(column.component) };
+				if (destinationColumn)
+				{
+					edge.links.push_back(ColumnLink{
+						column.component,
+						column.vector.get(),
+						destinationColumn });
+				}
+			}
+			edges.insert(component, std::move(edge));
+		}
+
+		void removeEdge(ComponentID component)
+		{
+			edges.erase(component);
+		}
+
+		void addColumn(ComponentID component, ComponentVectorBase column)
+		{
+			if (column)
+			{
+				insertColumn(component, std::move(column));
+			}
+			++version;
+		}
+
+		void removeColumn(ComponentID component)
+		{
+			Slot slot{ findSlot(component) };
+			if (slot != NO_SLOT)
+			{
+				if (slot != columns.size() - 1)
+				{
+					columns[slot] = std::move(columns.back());
+					slots[columns[slot].component] = slot;
+				}
+				columns.pop_back();
+				slots[component] = NO_SLOT;
+
+				while (!slots.empty() && slots.back() == NO_SLOT)
+				{
+					slots.pop_back();
+				}
+			}
+
+			++version;
+		}
+
+		void clearEntities()
+		{
+			for (Column& column : columns)
+			{
+				column.vector->clear();
+			}
+			ids.clear();
+			++version;
+		}
+
+		void reserve(size_t capacity)
+		{
+			for (Column& column : columns)
+			{
+				column.vector->reserve(capacity);
+			}
+			ids.reserve(capacity);
+		}
+
+		void shrinkToFit()
+		{
+			for (Column& column : columns)
+			{
+				column.vector->shrinkToFit();
+			}
+			ids.shrinkToFit();
+		}
+
 	private:
+		void markArray(size_t array)
+		{
+			if (arrayTicks[array] != *clock)
+			{
+				arrayTicks[array] = *clock;
+			}
+		}
+
+		void markRows(size_t first, size_t count)
+		{
+			if (!count)
+			{
+				return;
+			}
+
+			size_t last{ ByteC::getArrayIndex(first + count - 1) };
+			for (size_t array{ ByteC::getArrayIndex(first) }; array <= last; ++array)
+			{
+				arrayTicks[array] = *clock;
+			}
+		}
+
 		template<typename Type>
 		ComponentVector<Type>& getVector()
 		{
-			return static_cast<ComponentVector<Type>&>(*components.at(Component<Type>::getID()));
+			return static_cast<ComponentVector<Type>&>(*columns[slots[Component<Type>::getID()]].vector);
 		}
 
 		template<typename Type>
 		const ComponentVector<Type>& getVector() const
 		{
-			return static_cast<const ComponentVector<Type>&>(*components.at(Component<Type>::getID()));
+			return static_cast<const ComponentVector<Type>&>(*columns[slots[Component<Type>::getID()]].vector);
+		}
+
+		Slot findSlot(ComponentID component) const
+		{
+			if (component < slots.size())
+			{
+				return slots[component];
+			}
+			return NO_SLOT;
+		}
+
+		void insertColumn(ComponentID component, ComponentVectorBase column)
+		{
+			if (component >= slots.size())
+			{
+				slots.resize(component + 1, NO_SLOT);
+			}
+			slots[component] = static_cast<Slot>(columns.size());
+			columns.push_back(Column{ component, std::move(column) });
 		}
 	};
 
 	struct ClusterTraits
 	{
-		static Index carryEntity(Cluster& current, Cluster& destination, EntityID id)
+		static Index carryEntity(Cluster& current, ClusterEdge& edge, Index row)
 		{
-			destination.pushEntity(id);
-			Index index{current.indices.at(id)};
+			Index out{ edge.destination->pushEntity(current.ids.at(row)) };
+
+			for (ColumnLink& link : edge.links)
+			{
+				link.source->carry(row, *link.destination);
+			}
+
+			return out;
+		}
+
+		static Index carryEntities(Cluster& current, ClusterEdge& edge, const Index* rows, size_t count)
+		{
+			Cluster& destination{ *edge.destination };
+			Index out{ static_cast<Index>(destination.size()) };
+
+			destination.ids.increaseCapacity(destination.size() + count);
+			for (size_t index{}; index < count; ++index)
+			{
+				destination.ids.pushBack(current.ids.at(rows[index]));
+			}
+			destination.markRows(out, count);
+
+			for (ColumnLink& link : edge.links)
+			{
+				link.source->carry(rows, count, *link.destination);
+			}
+
+			return out;
+		}
+
+		static void link(Cluster& left, Cluster& right, ComponentID component)
+		{
+			left.setEdge(component, right);
+			right.setEdge(component, left);
+		}
+
+		static void unlink(Cluster& cluster)
+		{
+			for (auto& pair : cluster.edges)
+			{
+				pair.second.destination->removeEdge(pair.first);
+			}
+			cluster.edges.clear();
+		}
+
+		static Index carryAll(Cluster& current, ClusterEdge& edge)
+		{
+			Cluster& destination{ *edge.destination };
+			Index out{ static_cast<Index>(destination.size()) };
+
+			destination.ids.pushBack(current.ids, 0, current.size());
+			destination.markRows(out, current.size());
+			for (ColumnLink& link : edge.links)
+			{
+				link.source->carryRange(0, current.size(), *link.destination);
+			}
+
+			return out;
+		}
+
+		static Index carryEntity(Cluster& current, Cluster& destination, Index index)
+		{
+			destination.pushEntity(current.ids.at(index));
 
-			for (auto& pair : current.components)
+			for (Column& column : current.columns)
 			{
-				auto destitationArray{destination.components.find(pair.first)};
-				if (destitationArray.valid())
+				IComponentVector* destinationColumn{ destination.getColumn(column.component) };
+				if (destinationColumn)
 				{
-					ComponentAccessor::arrayCarry(
-						pair.first,
-						index,
-						*current.components[pair.first].get(),
-						*destitationArray->get());
+					column.vector->carry(index, *destinationColumn);
 				}
 			}
 
@@ -211,13 +997,9 @@ namespace ByteE
 		{
 			destination.pushEntity(id);
 
-			for (auto& pair : current.components)
+			for (const Column& column : current.columns)
 			{
-				ComponentAccessor::arrayCopy(
-					pair.first,
-					index,
-					*current.components[pair.first].get(),
-					*destination.components[pair.first].get());
+				column.vector->copyRange(index, 1, *destination.getColumn(column.component));
 			}
 
 			return static_cast<Index>(destination.size() - 1);
@@ -2,6 +2,8 @@
 #define B_CLUSTERCONTAINER_H
 
 #include <memory>
+#include <algorithm>
+#include <mutex>
 #include <set>
 #include <vector>
 #include <unordered_map>
@@ -9,60 +11,360 @@
 #include "config.h"
 #include "stair_map.h"
 #include "signature.h"
+#include "signature_registry.h"
 #include "cluster.h"
 #include "component.h"
 
 namespace ByteE
 {
 	using ClusterPointer = Cluster*;
-	using ClusterGroup = std::vector<Cluster*>;
+	using ClusterGroup = std::vector<Cluster*, Allocator<Cluster*>>;
+
+	struct QueryKey
+	{
+		Signature with;
+		Signature without;
+
+		bool operator==(const QueryKey& left) const
+		{
+			return with == left.with && without == left.without;
+		}
+
+		bool operator!=(const QueryKey& left) const
+		{
+			return !(*this == left);
+		}
+	};
+}
+
+namespace ByteA
+{
+	template<>
+	struct Hash<ByteE::QueryKey>
+	{
+		size_t operator()(const ByteE::QueryKey& key) const
+		{
+			Hash<ByteE::Signature> hasher;
+			return hasher(key.with) ^ (hasher(key.without) * 31);
+		}
+	};
+}
+
+namespace ByteE
+{
+	struct Query
+	{
+		QueryKey key;
+		ClusterGroup clusters;
+
+		bool match(const Signature& signature) const
+		{
+			return signature.subset(key.with) && !key.without.match(signature);
+		}
+	};
 
 	class ClusterContainer
 	{
 	public:
-		using Container = ByteC::StairMap<Signature, std::unique_ptr<Cluster>>;
+		using Container = std::vector<std::unique_ptr<Cluster>, Allocator<std::unique_ptr<Cluster>>>;
+		using QueryContainer = ByteC::StairMap<
+			QueryKey,
+			Query,
+			ByteA::Hash<QueryKey>,
+			Allocator<ByteC::MapNode<QueryKey, Query>>>;
+		using IndexContainer = std::vector<ClusterGroup, Allocator<ClusterGroup>>;
+
+		inline static constexpr size_t DEFAULT_RETENTION{ 64 };
 
 	private:
+		MemoryResource* resource;
+		SignatureRegistry signatures;
 		Container clusters;
+		QueryContainer queries;
+		IndexContainer componentClusters;
+		ClusterGroup idleClusters;
+		size_t retention{ DEFAULT_RETENTION };
+		std::unique_ptr<std::mutex> queryMutex{ std::make_unique<std::mutex>() };
 		ClusterID nextID{1};
+		uint64_t epoch{};
+		std::unique_ptr<Tick> tick{ std::make_unique<Tick>(1) };
 
 	public:
+		ClusterContainer(MemoryResource* resource = std::pmr::get_default_resource())
+			:resource{ resource }, signatures{ resource }, clusters{ resource }, queries{ resource }, componentClusters{ resource }, idleClusters{ resource }
+		{
+		}
+
+		MemoryResource* getResource() const
+		{
+			return resource;
+		}
+
+		const SignatureRegistry& getSignatures() const
+		{
+			return signatures;
+		}
+
 		Cluster& getCluster(const Signature& signature)
 		{
-			auto result{clusters.find(signature)};
+			return getCluster(signatures.intern(signature));
+		}
 
-			if (result.valid())
+		Cluster& getCluster(SignatureID signature)
+		{
+			Cluster* result{ findCluster(signature) };
+
+			if (result)
 			{
-				return *result.get();
+				return *result;
 			}
 
-			auto cluster{ std::make_unique<Cluster>(nextID++,signature) };
+			auto cluster{ std::make_unique<Cluster>(nextID++, signatures.get(signature), resource, tick.get()) };
 			Cluster& out{*cluster};
-			clusters.insert(signature, std::move(cluster));
+			attach(std::move(cluster));
 
 			return out;
 		}
 
+		Cluster* findCluster(const Signature& signature)
+		{
+			return findCluster(signatures.find(signature));
+		}
+
+		Cluster* findCluster(SignatureID signature)
+		{
+			if (signature < clusters.size())
+			{
+				return clusters[signature].get();
+			}
+			return nullptr;
+		}
+
+		template<typename Function>
+		void resignCluster(Cluster& cluster, const Signature& signature, Function&& function)
+		{
+			auto owned{ detach(cluster) };
+			function(cluster);
+			cluster.setSignature(signatures.get(signatures.intern(signature)));
+			attach(std::move(owned));
+		}
+
+		ClusterEdge& getEdge(Cluster& source, ComponentID component)
+		{
+			ClusterEdge* edge{ source.findEdge(component) };
+
+			if (edge)
+			{
+				return *edge;
+			}
+
+			Signature signature{ source.getSignature() };
+			signature.set(component, !signature.test(component));
+
+			ClusterTraits::link(source, getCluster(signature), component);
+
+			return *source.findEdge(component);
+		}
+
 		void checkCluster(Cluster& cluster)
 		{
-			if (cluster.empty())
+			markIdle(cluster);
+			evict();
+		}
+
+		void markIdle(Cluster& cluster)
+		{
+			if (!cluster.empty())
 			{
-				clusters.erase(cluster.getSignature());
+				return;
 			}
+
+			std::erase_if(idleClusters, [&cluster](ClusterPointer idle)
+			{
+				return idle == &cluster || !idle->empty();
+			});
+			idleClusters.push_back(&cluster);
+		}
+
+		void evict()
+		{
+			while (idleClusters.size() > retention)
+			{
+				Cluster& oldest{ *idleClusters.front() };
+				idleClusters.erase(idleClusters.begin());
+
+				if (oldest.empty())
+				{
+					detach(oldest).reset();
+					++epoch;
+				}
+			}
+		}
+
+		void setRetention(size_t budget)
+		{
+			retention = budget;
+			evict();
+		}
+
+		size_t getRetention() const
+		{
+			return retention;
+		}
+
+		void shrinkToFit()
+		{
+			for (auto& cluster : clusters)
+			{
+				if (cluster)
+				{
+					cluster->shrinkToFit();
+				}
+			}
+		}
+
+		void clear()
+		{
+			for (auto& pair : queries)
+			{
+				pair.second.clusters.clear();
+			}
+			componentClusters.clear();
+			idleClusters.clear();
+			clusters.clear();
+			++epoch;
+		}
+
+		uint64_t getEpoch() const
+		{
+			return epoch;
+		}
+
+		Tick getTick() const
+		{
+			return *tick;
+		}
+
+		Tick advanceTick()
+		{
+			return ++*tick;
 		}
 
 		ClusterGroup getClusters(const Signature& with, const Signature& without)
 		{
-			std::vector<ClusterPointer> out;
-			for (auto& pair : clusters)
+			ClusterGroup out{ resource };
+			const auto& required{ with.query() };
+
+			if (required.empty())
 			{
-				if (with.subset(pair.first) && !without.match(pair.first))
+				for (auto& cluster : clusters)
 				{
-					out.push_back(pair.second.get());
+					if (cluster && !without.match(cluster->getSignature()))
+					{
+						out.push_back(cluster.get());
+					}
+				}
+				return out;
+			}
+
+			ComponentID rarest{ required.front() };
+			for (ComponentID id : required)
+			{
+				if (id >= componentClusters.size())
+				{
+					return out;
+				}
+				if (componentClusters[id].size() < componentClusters[rarest].size())
+				{
+					rarest = id;
+				}
+			}
+
+			for (ClusterPointer cluster : componentClusters[rarest])
+			{
+				const Signature& signature{ cluster->getSignature() };
+				if (signature.subset(with) && !without.match(signature))
+				{
+					out.push_back(cluster);
 				}
 			}
 			return out;
 		}
+
+		ClusterGroup& getQuery(const Signature& with, const Signature& without)
+		{
+			std::lock_guard<std::mutex> lock{ *queryMutex };
+			QueryKey key{ with, without };
+			auto result{ queries.find(key) };
+
+			if (result.valid())
+			{
+				return result->clusters;
+			}
+
+			Query query{ key, getClusters(with, without) };
+			queries.insert(key, std::move(query));
+
+			return queries.at(key).clusters;
+		}
+
+	private:
+		void attach(std::unique_ptr<Cluster> cluster)
+		{
+			Cluster& out{ *cluster };
+			const Signature& signature{ out.getSignature() };
+			SignatureID signatureID{ out.getSignatureID() };
+
+			if (signatureID >= clusters.size())
+			{
+				clusters.resize(signatureID + 1);
+			}
+			clusters[signatureID] = std::move(cluster);
+
+			for (ComponentID id : out.getComponentIDs())
+			{
+				if (id >= componentClusters.size())
+				{
+					componentClusters.resize(id + 1);
+				}
+				componentClusters[id].push_back(&out);
+			}
+
+			for (auto& pair : queries)
+			{
+				if (pair.second.match(signature))
+				{
+					pair.second.clusters.push_back(&out);
+				}
+			}
+		}
+
+		[[nodiscard]] std::unique_ptr<Cluster> detach(Cluster& cluster)
+		{
+			ClusterTraits::unlink(cluster);
+
+			for (ComponentID id : cluster.getComponentIDs())
+			{
+				removeFromGroup(componentClusters[id], cluster);
+			}
+
+			for (auto& pair : queries)
+			{
+				if (pair.second.match(cluster.getSignature()))
+				{
+					removeFromGroup(pair.second.clusters, cluster);
+				}
+			}
+
+			return std::move(clusters[cluster.getSignatureID()]);
+		}
+
+		static void removeFromGroup(ClusterGroup& group, Cluster& cluster)
+		{
+			auto position{ std::find(group.begin(), group.end(), &cluster) };
+			*position = group.back();
+			group.pop_back();
+		}
 	};
 
 
@@ -0,0 +1,472 @@
+#ifndef B_COMMANDBUFFER_H
+#define B_COMMANDBUFFER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "config.h"
+#include "component.h"
+#include "component_vector.h"
+#include "cluster.h"
+#include "pool.h"
+
+namespace ByteE
+{
+
+	enum class CommandType : uint8_t
+	{
+		Add,
+		Remove,
+		Destroy,
+		Sparse
+	};
+
+	class CommandBuffer
+	{
+	public:
+		using Assign = void(*)(IComponentVector&, Index, Cluster&, Index);
+		using Apply = void(*)(SparseContainer&, IComponentVector*, Index, EntityID);
+
+		struct Command
+		{
+			EntityID entity;
+			ComponentID component;
+			CommandType type;
+			Index payload;
+			Assign assign;
+			Index round;
+			Apply apply;
+		};
+
+		using CommandContainer = std::vector<Command>;
+		using PayloadContainer = std::vector<ComponentVectorBase>;
+
+	private:
+		struct Pending
+		{
+			Cluster* source;
+			Command* command;
+		};
+
+		struct Move
+		{
+			Index row;
+			EntityID entity;
+			Index payload;
+		};
+
+		using PendingContainer = std::vector<Pending>;
+		using OrderContainer = std::vector<Command*>;
+		using SourceContainer = std::vector<Cluster*>;
+		using MoveContainer = std::vector<Move>;
+		using RowContainer = std::vector<Index>;
+		using IDContainer = std::vector<EntityID>;
+
+		CommandContainer commands;
+		PayloadContainer payloads;
+
+		OrderContainer ordered;
+		RowContainer roundStarts;
+		MoveContainer moves;
+		RowContainer rows;
+		RowContainer payloadRows;
+		IDContainer entityIDs;
+
+	public:
+		template<typename Type>
+		void addComponent(EntityID id, Type component)
+		{
+			emplaceComponent<Type>(id, std::move(component));
+		}
+
+		template<typename Type, typename... Args>
+		void emplaceComponent(EntityID id, Args&&... args)
+		{
+			ComponentID componentID{ Component<Type>::getID() };
+
+			if constexpr (StorageTraits<Type>::TAG)
+			{
+				commands.push_back(Command{ id, componentID, CommandType::Add, 0, nullptr, 0, nullptr });
+			}
+			else
+			{
+				ComponentVector<Type>& payload{ getPayload<Type>() };
+				payload.emplaceBack(std::forward<Args>(args)...);
+
+				if constexpr (ComponentStorage<Type>::SPARSE)
+				{
+					commands.push_back(Command{
+						id,
+						componentID,
+						CommandType::Sparse,
+						static_cast<Index>(payload.size() - 1),
+						nullptr,
+						0,
+						&emplaceSparse<Type> });
+				}
+				else
+				{
+					commands.push_back(Command{
+						id,
+						componentID,
+						CommandType::Add,
+						static_cast<Index>(payload.size() - 1),
+						&assignPayload<Type>,
+						0,
+						nullptr });
+				}
+			}
+		}
+
+		template<typename Type>
+		void removeComponent(EntityID id)
+		{
+			if constexpr (ComponentStorage<Type>::SPARSE)
+			{
+				commands.push_back(Command{ id, Component<Type>::getID(), CommandType::Sparse, 0, nullptr, 0, &removeSparse<Type> });
+			}
+			else
+			{
+				commands.push_back(Command{ id, Component<Type>::getID(), CommandType::Remove, 0, nullptr, 0, nullptr });
+			}
+		}
+
+		void destroyEntity(EntityID id)
+		{
+			commands.push_back(Command{ id, 0, CommandType::Destroy, 0, nullptr, 0, nullptr });
+		}
+
+		size_t size() const
+		{
+			return commands.size();
+		}
+
+		bool empty() const
+		{
+			return commands.empty();
+		}
+
+		void clear()
+		{
+			commands.clear();
+			for (ComponentVectorBase& payload : payloads)
+			{
+				if (payload)
+				{
+					payload->clear();
+				}
+			}
+		}
+
+		void flush(Pool& pool)
+		{
+			if (commands.empty())
+			{
+				return;
+			}
+
+			std::stable_sort(commands.begin(), commands.end(), [](const Command& left, const Command& right)
+			{
+				return left.entity < right.entity;
+			});
+
+			Index roundCount{};
+			for (size_t index{}; index < commands.size(); ++index)
+			{
+				bool sameEntity{ index > 0 && commands[index - 1].entity == commands[index].entity };
+				commands[index].round = sameEntity ? commands[index - 1].round + 1 : 0;
+				roundCount = std::max(roundCount, static_cast<Index>(commands[index].round + 1));
+			}
+
+			bucketRounds(roundCount);
+
+			PendingContainer pending;
+			for (Index round{}; round < roundCount; ++round)
+			{
+				pending.clear();
+				for (Index index{ roundStarts[round] }; index < roundStarts[round + 1]; ++index)
+				{
+					Command& command{ *ordered[index] };
+					if (pool.entities.contains(command.entity))
+					{
+						pending.push_back(Pending{ pool.entities.getCluster(command.entity), &command });
+					}
+				}
+
+				std::sort(pending.begin(), pending.end(), [](const Pending& left, const Pending& right)
+				{
+					if (left.source != right.source)
+					{
+						return left.source < right.source;
+					}
+					if (left.command->component != right.command->component)
+					{
+						return left.command->component < right.command->component;
+					}
+					return left.command->type < right.command->type;
+				});
+
+				applyRound(pool, pending);
+			}
+
+			clear();
+		}
+
+	private:
+		void bucketRounds(Index roundCount)
+		{
+			roundStarts.assign(roundCount + 1, 0);
+			for (const Command& command : commands)
+			{
+				++roundStarts[command.round + 1];
+			}
+			for (Index round{}; round < roundCount; ++round)
+			{
+				roundStarts[round + 1] += roundStarts[round];
+			}
+
+			RowContainer cursors{ roundStarts };
+			ordered.resize(commands.size());
+			for (Command& command : commands)
+			{
+				ordered[cursors[command.round]++] = &command;
+			}
+		}
+
+		template<typename Type>
+		ComponentVector<Type>& getPayload()
+		{
+			ComponentID componentID{ Component<Type>::getID() };
+			if (componentID >= payloads.size())
+			{
+				payloads.resize(componentID + 1);
+			}
+			if (!payloads[componentID])
+			{
+				payloads[componentID] = ComponentAccessor::createArray(componentID);
+			}
+			return static_cast<ComponentVector<Type>&>(*payloads[componentID]);
+		}
+
+		IComponentVector* getPayload(ComponentID component)
+		{
+			if (component < payloads.size())
+			{
+				return payloads[component].get();
+			}
+			return nullptr;
+		}
+
+		template<typename Type>
+		static void assignPayload(IComponentVector& payload, Index payloadRow, Cluster& cluster, Index row)
+		{
+			Type& component{ static_cast<ComponentVector<Type>&>(payload).at(payloadRow) };
+			cluster.setComponent<Type>(row, std::move(component));
+		}
+
+		template<typename Type>
+		static void emplaceSparse(SparseContainer& sparse, IComponentVector* payload, Index payloadRow, EntityID id)
+		{
+			Type& component{ static_cast<ComponentVector<Type>*>(payload)->at(payloadRow) };
+			sparse.getSet<Type>().emplace(id, std::move(component));
+		}
+
+		template<typename Type>
+		static void removeSparse(SparseContainer& sparse, IComponentVector*, Index, EntityID id)
+		{
+			SparseSet<Type>* set{ sparse.findSet<Type>() };
+			if (set)
+			{
+				set->remove(id);
+			}
+		}
+
+		void applyRound(Pool& pool, PendingContainer& pending)
+		{
+			SourceContainer sources;
+
+			for (size_t first{}; first < pending.size();)
+			{
+				size_t last{ first + 1 };
+				while (last < pending.size() &&
+					pending[last].source == pending[first].source &&
+					pending[last].command->component == pending[first].command->component &&
+					pending[last].command->type == pending[first].command->type)
+				{
+					++last;
+				}
+
+				Cluster* source{ pending[first].source };
+				if (source && (sources.empty() || sources.back() != source))
+				{
+					sources.push_back(source);
+				}
+
+				switch (pending[first].command->type)
+				{
+				case CommandType::Add:
+					applyAdd(pool, pending, first, last);
+					break;
+				case CommandType::Remove:
+					applyRemove(pool, pending, first, last);
+					break;
+				case CommandType::Destroy:
+					applyDestroy(pool, pending, first, last);
+					break;
+				case CommandType::Sparse:
+					applySparse(pool, pending, first, last);
+					break;
+				}
+
+				first = last;
+			}
+
+			for (Cluster* source : sources)
+			{
+				pool.clusters.markIdle(*source);
+			}
+			pool.clusters.evict();
+		}
+
+		void applyAdd(Pool& pool, PendingContainer& pending, size_t first, size_t last)
+		{
+			Cluster* source{ pending[first].source };
+			ComponentID component{ pending[first].command->component };
+			IComponentVector* payload{ getPayload(component) };
+
+			if (source && source->getSignature().test(component))
+			{
+				if (!payload)
+				{
+					return;
+				}
+
+				for (size_t index{ first }; index < last; ++index)
+				{
+					const Command& command{ *pending[index].command };
+					command.assign(*payload, command.payload, *source, pool.entities.getRecord(command.entity).row);
+				}
+				return;
+			}
+
+			gather(pool, pending, first, last);
+
+			if (source)
+			{
+				ClusterEdge& edge{ pool.clusters.getEdge(*source, component) };
+				migrate(pool, *source, edge);
+				if (payload)
+				{
+					payload->carryStamped(payloadRows.data(), payloadRows.size(), *edge.destination->getColumn(component));
+				}
+				return;
+			}
+
+			Signature signature;
+			signature.set(component);
+			Cluster& destination{ pool.clusters.getCluster(signature) };
+
+			Index firstRow{ destination.pushEntities(entityIDs) };
+			if (payload)
+			{
+				payload->carryStamped(payloadRows.data(), payloadRows.size(), *destination.getColumn(component));
+			}
+
+			for (size_t index{}; index < entityIDs.size(); ++index)
+			{
+				pool.entities.setCluster(entityIDs[index], destination, static_cast<Index>(firstRow + index));
+			}
+		}
+
+		void applyRemove(Pool& pool, PendingContainer& pending, size_t first, size_t last)
+		{
+			Cluster* source{ pending[first].source };
+			ComponentID component{ pending[first].command->component };
+
+			if (!source || !source->getSignature().test(component))
+			{
+				return;
+			}
+
+			gather(pool, pending, first, last);
+
+			if (source->componentCount() == 1)
+			{
+				pool.eraseRows(*source, rows.data(), rows.size());
+				for (EntityID id : entityIDs)
+				{
+					pool.entities.resetCluster(id);
+				}
+				return;
+			}
+
+			migrate(pool, *source, pool.clusters.getEdge(*source, component));
+		}
+
+		void gather(Pool& pool, PendingContainer& pending, size_t first, size_t last)
+		{
+			moves.clear();
+			for (size_t index{ first }; index < last; ++index)
+			{
+				const Command& command{ *pending[index].command };
+				moves.push_back(Move{ pool.entities.getRecord(command.entity).row, command.entity, command.payload });
+			}
+
+			std::sort(moves.begin(), moves.end(), [](const Move& left, const Move& right)
+			{
+				return left.row > right.row;
+			});
+
+			rows.clear();
+			entityIDs.clear();
+			payloadRows.clear();
+			for (const Move& move : moves)
+			{
+				rows.push_back(move.row);
+				entityIDs.push_back(move.entity);
+				payloadRows.push_back(move.payload);
+			}
+		}
+
+		void migrate(Pool& pool, Cluster& source, ClusterEdge& edge)
+		{
+			Index firstRow{ ClusterTraits::carryEntities(source, edge, rows.data(), rows.size()) };
+			pool.eraseRows(source, rows.data(), rows.size());
+
+			for (size_t index{}; index < entityIDs.size(); ++index)
+			{
+				pool.entities.setCluster(entityIDs[index], *edge.destination, static_cast<Index>(firstRow + index));
+			}
+		}
+
+		void applySparse(Pool& pool, PendingContainer& pending, size_t first, size_t last)
+		{
+			for (size_t index{ first }; index < last; ++index)
+			{
+				const Command& command{ *pending[index].command };
+				command.apply(pool.sparse, getPayload(command.component), command.payload, command.entity);
+			}
+		}
+
+		void applyDestroy(Pool& pool, PendingContainer& pending, size_t first, size_t last)
+		{
+			Cluster* source{ pending[first].source };
+
+			for (size_t index{ first }; index < last; ++index)
+			{
+				EntityID id{ pending[index].command->entity };
+				if (source)
+				{
+					pool.eraseRow(*source, pool.entities.getRecord(id).row);
+				}
+				pool.sparse.removeEntity(id);
+				pool.entities.removeEntity(id);
+			}
+		}
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -13,51 +13,47 @@
 namespace ByteE
 {
 
+	template<typename Type>
+	struct ComponentStorage
+	{
+		inline static constexpr bool SPARSE{ false };
+	};
+
+	template<typename Type>
+	struct StorageTraits
+	{
+		inline static constexpr bool SPARSE{ ComponentStorage<Type>::SPARSE };
+		inline static constexpr bool TAG{ std::is_empty_v<Type> && !SPARSE };
+
+		static Type& getTag()
+		{
+			static Type tag{};
+			return tag;
+		}
+	};
+
 	class IComponentMask
 	{
 	public:
 		virtual ~IComponentMask() = default;
 
-		virtual void arrayCarry(
-			Index index, 
-			IComponentVector& old, 
-			IComponentVector& dest) const = 0;
-
-		virtual void arrayCopy(
-			Index index, 
-			const IComponentVector& old, 
-			IComponentVector& dest) const = 0;
-
-		virtual ComponentVectorBase createArray() const = 0;
+		virtual ComponentVectorBase createArray(MemoryResource* resource, const Tick* clock) const = 0;
 	};
 
 	template<typename Type>
 	class ComponentMask : public IComponentMask
 	{
 	public:
-		void arrayCarry(
-			Index index, 
-			IComponentVector& old,
-			IComponentVector& dest) const override
+		ComponentVectorBase createArray(MemoryResource* resource, const Tick* clock) const override
 		{
-			auto& castedOld{ static_cast<ComponentVector<Type>&>(old) };
-			auto& castedDest{ static_cast<ComponentVector<Type>&>(dest) };
-			castedDest.pushBack(std::move(castedOld.at(index)));
-		}
-
-		void arrayCopy(
-			Index index, 
-			const IComponentVector& old, 
-			IComponentVector& dest) const override
-		{
-			auto& castedOld{ static_cast<const ComponentVector<Type>&>(old) };
-			auto& castedDest{ static_cast<ComponentVector<Type>&>(dest) };
-			castedDest.pushBack(castedOld.at(index));
-		}
-
-		ComponentVectorBase createArray() const override
-		{
-			return std::make_unique<ComponentVector<Type>>();
+			if constexpr (StorageTraits<Type>::TAG)
+			{
+				return nullptr;
+			}
+			else
+			{
+				return std::make_unique<ComponentVector<Type>>(resource, clock);
+			}
 		}
 	};
 
@@ -88,27 +84,12 @@ namespace ByteE
 
 	struct ComponentAccessor
 	{
-		static void arrayCarry(
+		static ComponentVectorBase createArray(
 			ComponentID id, 
-			Index index, 
-			IComponentVector& old,
-			IComponentVector& dest)
-		{
-			MaskContainer::getAccessor(id).arrayCarry(index, old, dest);
-		}
-
-		static void arrayCopy(
-			ComponentID id, 
-			Index index, 
-			const IComponentVector& old, 
-			IComponentVector& dest)
-		{
-			MaskContainer::getAccessor(id).arrayCopy(index, old, dest);
-		}
-
-		static ComponentVectorBase createArray(ComponentID id)
+			MemoryResource* resource = std::pmr::get_default_resource(), 
+			const Tick* clock = &nullTick)
 		{
-			return MaskContainer::getAccessor(id).createArray();
+			return MaskContainer::getAccessor(id).createArray(resource, clock);
 		}
 	};
 
@@ -4,6 +4,10 @@
 #include <memory>
 #include <cstdint>
 #include <algorithm>
+#include <utility>
+#include <array>
+#include <variant>
+#include <type_traits>
 
 #include "config.h"
 #include "stair_map.h"
@@ -23,31 +27,272 @@ namespace ByteE
 
 		virtual void swap(size_t left, size_t right) = 0;
 
+		virtual void swapRemove(size_t index) = 0;
+
+		virtual void swapRemove(const Index* rows, size_t count) = 0;
+
+		virtual void carry(size_t index, IComponentVector& destination) = 0;
+
+		virtual void carry(const Index* rows, size_t count, IComponentVector& destination) = 0;
+
+		virtual void carryStamped(const Index* rows, size_t count, IComponentVector& destination) = 0;
+
+		virtual void carryRange(size_t first, size_t count, IComponentVector& destination) = 0;
+
+		virtual void copyRange(size_t first, size_t count, IComponentVector& destination) const = 0;
+
+		virtual void clear() = 0;
+
+		virtual void reserve(size_t capacity) = 0;
+
+		virtual void shrinkToFit() = 0;
+
 		virtual size_t size() const = 0;
 		
 		virtual ComponentVectorBase copy() const = 0;
 	};
 
+	template<typename Type>
+	struct ChangeTracking
+	{
+		inline static constexpr bool ROW_TICKS{ false };
+	};
+
 	template <typename Type>
-	class ComponentVector: public ByteC::StairVector<Type>, public IComponentVector
+	class ComponentVector: public ByteC::StairVector<Type, Allocator<Type>>, public IComponentVector
 	{
 	public:
 		using ComponentType = Type;
-		using ContainerBase = ByteC::StairVector<ComponentType>;
+		using ContainerBase = ByteC::StairVector<ComponentType, Allocator<ComponentType>>;
+
+		inline static constexpr bool ROW_TICKS{ ChangeTracking<Type>::ROW_TICKS };
+
+		using ArrayTicks = std::array<Tick, ByteC::ArrayContainer<Type>::MAX_ARRAYS>;
+		using RowTicks = std::conditional_t<ROW_TICKS, ByteC::StairVector<Tick, Allocator<Tick>>, std::monostate>;
+
+	private:
+		const Tick* clock{ &nullTick };
+		ArrayTicks arrayTicks{};
+		[[no_unique_address]] RowTicks rowTicks;
 
 	public:
 		ComponentVector() = default;
 
+		ComponentVector(MemoryResource* resource, const Tick* clock = &nullTick)
+			:ContainerBase{ Allocator<ComponentType>{ resource } }, 
+			clock{ clock }, 
+			rowTicks{ createRowTicks(resource) }
+		{
+		}
+
 		~ComponentVector() = default;
 
+		template<typename... Args>
+		ComponentType& emplaceBack(Args&&... args)
+		{
+			ComponentType& out{ ContainerBase::emplaceBack(std::forward<Args>(args)...) };
+			if constexpr (ROW_TICKS)
+			{
+				rowTicks.pushBack(*clock);
+			}
+			return out;
+		}
+
+		void pushBack(const ComponentType& component)
+		{
+			emplaceBack(component);
+		}
+
+		void pushBack(ComponentType&& component)
+		{
+			emplaceBack(std::move(component));
+		}
+
+		void pushBack(size_t count, const ComponentType& component)
+		{
+			ContainerBase::pushBack(count, component);
+			pushTicks(count);
+		}
+
+		void pushBack(ComponentVector& source, size_t first, size_t count)
+		{
+			ContainerBase::pushBack(static_cast<ContainerBase&>(source), first, count);
+			pushTicks(source, first, count);
+		}
+
+		void pushBack(const ComponentVector& source, size_t first, size_t count)
+		{
+			ContainerBase::pushBack(static_cast<const ContainerBase&>(source), first, count);
+			pushTicks(source, first, count);
+		}
+
+		void markChanged(size_t row)
+		{
+			markArray(ByteC::getArrayIndex(row));
+			if constexpr (ROW_TICKS)
+			{
+				rowTicks.at(row) = *clock;
+			}
+		}
+
+		void markArray(size_t array)
+		{
+			if (arrayTicks[array] != *clock)
+			{
+				arrayTicks[array] = *clock;
+			}
+		}
+
+		void markRun(size_t first, size_t count)
+		{
+			if constexpr (ROW_TICKS)
+			{
+				std::fill_n(&rowTicks.at(first), count, *clock);
+			}
+		}
+
+		Tick getArrayTick(size_t array) const
+		{
+			return arrayTicks[array];
+		}
+
+		const Tick* getRowTicks(size_t array) const
+		{
+			if constexpr (ROW_TICKS)
+			{
+				return rowTicks.data().at(array);
+			}
+			else
+			{
+				return nullptr;
+			}
+		}
+
+		const Tick* getClock() const
+		{
+			return clock;
+		}
+
 		void popBack() override
 		{
 			ContainerBase::popBack();
+			if constexpr (ROW_TICKS)
+			{
+				rowTicks.popBack();
+			}
 		}
 
 		void swap(size_t left, size_t right) override
 		{
 			std::swap(ContainerBase::at(left), ContainerBase::at(right));
+			if constexpr (ROW_TICKS)
+			{
+				std::swap(rowTicks.at(left), rowTicks.at(right));
+			}
+			markArray(ByteC::getArrayIndex(left));
+			markArray(ByteC::getArrayIndex(right));
+		}
+
+		void swapRemove(size_t index) override
+		{
+			ContainerBase::swapRemove(index);
+			if constexpr (ROW_TICKS)
+			{
+				rowTicks.swapRemove(index);
+			}
+		}
+
+		void swapRemove(const Index* rows, size_t count) override
+		{
+			size_t last{ ContainerBase::size() };
+			for (size_t index{}; index < count; ++index)
+			{
+				--last;
+				if (rows[index] != last)
+				{
+					ContainerBase::at(rows[index]) = std::move(ContainerBase::at(last));
+					if constexpr (ROW_TICKS)
+					{
+						rowTicks.at(rows[index]) = rowTicks.at(last);
+					}
+				}
+			}
+			ContainerBase::popBack(count);
+			if constexpr (ROW_TICKS)
+			{
+				rowTicks.popBack(count);
+			}
+		}
+
+		void carry(size_t index, IComponentVector& destination) override
+		{
+			carryRow(index, cast(destination));
+		}
+
+		void carry(const Index* rows, size_t count, IComponentVector& destination) override
+		{
+			ComponentVector& target{ cast(destination) };
+			target.increaseCapacity(target.size() + count);
+			for (size_t index{}; index < count; ++index)
+			{
+				carryRow(rows[index], target);
+			}
+		}
+
+		void carryStamped(const Index* rows, size_t count, IComponentVector& destination) override
+		{
+			ComponentVector& target{ cast(destination) };
+			target.increaseCapacity(target.size() + count);
+			for (size_t index{}; index < count; ++index)
+			{
+				target.emplaceBack(std::move(ContainerBase::at(rows[index])));
+			}
+		}
+
+		void carryRange(size_t first, size_t count, IComponentVector& destination) override
+		{
+			cast(destination).pushBack(*this, first, count);
+		}
+
+		void copyRange(size_t first, size_t count, IComponentVector& destination) const override
+		{
+			cast(destination).pushBack(*this, first, count);
+		}
+
+		void clear() override
+		{
+			ContainerBase::clear();
+			if constexpr (ROW_TICKS)
+			{
+				rowTicks.clear();
+			}
+		}
+
+		void reserve(size_t capacity) override
+		{
+			ContainerBase::reserve(capacity);
+			if constexpr (ROW_TICKS)
+			{
+				rowTicks.reserve(capacity);
+			}
+		}
+
+		void increaseCapacity(size_t capacity)
+		{
+			ContainerBase::increaseCapacity(capacity);
+			if constexpr (ROW_TICKS)
+			{
+				rowTicks.increaseCapacity(capacity);
+			}
+		}
+
+		void shrinkToFit() override
+		{
+			ContainerBase::shrinkToFit();
+			if constexpr (ROW_TICKS)
+			{
+				rowTicks.shrinkToFit();
+			}
 		}
 
 		virtual size_t size() const
@@ -59,6 +304,65 @@ namespace ByteE
 		{
 			return std::make_unique<ComponentVector<ComponentType>>((*this));
 		}
+
+	private:
+		void carryRow(size_t index, ComponentVector& target)
+		{
+			target.emplaceBack(std::move(ContainerBase::at(index)));
+			if constexpr (ROW_TICKS)
+			{
+				target.rowTicks.back() = rowTicks.at(index);
+			}
+		}
+
+		void pushTicks(size_t count)
+		{
+			markArrays(ContainerBase::size() - count, count);
+			if constexpr (ROW_TICKS)
+			{
+				rowTicks.pushBack(count, *clock);
+			}
+		}
+
+		void pushTicks(const ComponentVector& source, size_t first, size_t count)
+		{
+			markArrays(ContainerBase::size() - count, count);
+			if constexpr (ROW_TICKS)
+			{
+				rowTicks.pushBack(source.rowTicks, first, count);
+			}
+		}
+
+		void markArrays(size_t first, size_t count)
+		{
+			if (!count)
+			{
+				return;
+			}
+
+			size_t last{ ByteC::getArrayIndex(first + count - 1) };
+			for (size_t array{ ByteC::getArrayIndex(first) }; array <= last; ++array)
+			{
+				arrayTicks[array] = *clock;
+			}
+		}
+
+		static RowTicks createRowTicks(MemoryResource* resource)
+		{
+			if constexpr (ROW_TICKS)
+			{
+				return RowTicks{ Allocator<Tick>{ resource } };
+			}
+			else
+			{
+				return RowTicks{};
+			}
+		}
+
+		static ComponentVector& cast(IComponentVector& vector)
+		{
+			return static_cast<ComponentVector&>(vector);
+		}
 	};
 
 }
@@ -2,7 +2,9 @@
 #define	B_CONFIG_H
 
 #include <cstdint>
+#include <limits>
 #include <string>
+#include <memory_resource>
 
 namespace ByteE
 {
@@ -12,11 +14,22 @@ namespace ByteE
 	using ComponentID = uint32_t;
 	using EntityID = uint64_t;
 	using ClusterID = uint64_t;
+	using Generation = uint32_t;
+	using SignatureID = uint32_t;
+	using Tick = uint64_t;
 
 	using ComponentName = std::string;
 
+	using MemoryResource = std::pmr::memory_resource;
+
+	template<typename Type>
+	using Allocator = std::pmr::polymorphic_allocator<Type>;
+
 	inline constexpr EntityID nullEntity{ 0 };
 	inline constexpr ClusterID nullCluster{ 0 };
+	inline constexpr SignatureID emptySignature{ 0 };
+	inline constexpr SignatureID nullSignature{ std::numeric_limits<SignatureID>::max() };
+	inline constexpr Tick nullTick{ 0 };
 
 	inline constexpr size_t MAX_COMPONENT_COUNT{ 1024 };
 
@@ -1,7 +1,10 @@
 #ifndef B_ENTITYCONTAINER_H
 #define B_ENTITYCONTAINER_H
 
-#include "stair_map.h"
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
 #include "cluster.h"
 
 #include "config.h"
@@ -9,42 +12,171 @@
 namespace ByteE
 {
 
+	struct EntityRecord
+	{
+		Cluster* cluster{ nullptr };
+		Index row{};
+		Generation generation{};
+	};
+
 	class EntityContainer
 	{
 	public:
 		using ClusterPointer = Cluster*;
-		using Container = ByteC::StairMap<EntityID,ClusterPointer>;
+		using Container = std::vector<EntityRecord, Allocator<EntityRecord>>;
+		using SlotContainer = std::vector<Index, Allocator<Index>>;
 
 	private:
-		Container dataContainer;
-		EntityID nextID{1};
+		Container records;
+		SlotContainer freeSlots;
 
 	public:
+		EntityContainer(MemoryResource* resource = std::pmr::get_default_resource())
+			:records{ 1, resource }, freeSlots{ resource }
+		{
+		}
+
+		static Index getSlot(EntityID id)
+		{
+			return static_cast<Index>(id);
+		}
+
+		static Generation getGeneration(EntityID id)
+		{
+			return static_cast<Generation>(id >> 32);
+		}
+
+		static EntityID createID(Index slot, Generation generation)
+		{
+			return (static_cast<EntityID>(generation) << 32) | slot;
+		}
+
 		EntityID createEntity()
 		{
-			EntityID id{ nextID++ };
-			dataContainer.insert(id, nullptr);
-			return id;
+			return assignSlot(acquireSlot(), nullptr, 0);
+		}
+
+		std::vector<EntityID> createEntities(size_t count, ClusterPointer cluster = nullptr, Index firstRow = 0)
+		{
+			std::vector<EntityID> out;
+			out.reserve(count);
+
+			size_t recycled{ std::min(count, freeSlots.size()) };
+			records.reserve(records.size() + count - recycled);
+
+			for (size_t index{}; index < count; ++index)
+			{
+				Index row{ static_cast<Index>(firstRow + index) };
+				out.push_back(assignSlot(acquireSlot(), cluster, row));
+			}
+
+			return out;
 		}
 
 		void removeEntity(EntityID id)
 		{
-			dataContainer.erase(id);
+			Index slot{ getSlot(id) };
+			EntityRecord& record{ records[slot] };
+			record.cluster = nullptr;
+			++record.generation;
+			freeSlots.push_back(slot);
+		}
+
+		void removeEntities(const Cluster::IDContainer& ids)
+		{
+			freeSlots.reserve(freeSlots.size() + ids.size());
+			for (EntityID id : ids)
+			{
+				removeEntity(id);
+			}
+		}
+
+		void clear()
+		{
+			freeSlots.clear();
+			freeSlots.reserve(records.size() - 1);
+
+			for (size_t slot{ records.size() - 1 }; slot > 0; --slot)
+			{
+				EntityRecord& record{ records[slot] };
+				record.cluster = nullptr;
+				++record.generation;
+				freeSlots.push_back(static_cast<Index>(slot));
+			}
+		}
+
+		bool contains(EntityID id) const
+		{
+			Index slot{ getSlot(id) };
+			return slot != 0 && slot < records.size() && records[slot].generation == getGeneration(id);
+		}
+
+		EntityRecord& getRecord(EntityID id)
+		{
+			assert(contains(id));
+			return records[getSlot(id)];
+		}
+
+		const EntityRecord& getRecord(EntityID id) const
+		{
+			assert(contains(id));
+			return records[getSlot(id)];
 		}
 
 		ClusterPointer getCluster(EntityID id)
 		{
-			return dataContainer.at(id);
+			return contains(id) ? records[getSlot(id)].cluster : nullptr;
 		}
 
 		const ClusterPointer getCluster(EntityID id) const
 		{
-			return dataContainer.at(id);
+			return contains(id) ? records[getSlot(id)].cluster : nullptr;
+		}
+
+		void setCluster(EntityID id, Cluster& cluster, Index row)
+		{
+			assert(contains(id));
+			EntityRecord& record{ records[getSlot(id)] };
+			record.cluster = &cluster;
+			record.row = row;
+		}
+
+		void setRow(EntityID id, Index row)
+		{
+			records[getSlot(id)].row = row;
+		}
+
+		void resetCluster(EntityID id)
+		{
+			assert(contains(id));
+			records[getSlot(id)].cluster = nullptr;
+		}
+
+		size_t size() const
+		{
+			return records.size() - freeSlots.size() - 1;
+		}
+
+	private:
+		Index acquireSlot()
+		{
+			if (freeSlots.empty())
+			{
+				records.push_back(EntityRecord{});
+				return static_cast<Index>(records.size() - 1);
+			}
+
+			Index slot{ freeSlots.back() };
+			freeSlots.pop_back();
+			return slot;
 		}
 
-		void setCluster(EntityID id, Cluster& cluster)
+		EntityID assignSlot(Index slot, ClusterPointer cluster, Index row)
 		{
-			dataContainer[id] = &cluster;
+			EntityRecord& record{ records[slot] };
+			record.cluster = cluster;
+			record.row = row;
+			return createID(slot, record.generation);
 		}
 	};
 
@@ -0,0 +1,146 @@
+#ifndef B_ENTITYREF_H
+#define B_ENTITYREF_H
+
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "config.h"
+#include "cluster.h"
+#include "cluster_container.h"
+#include "entity_container.h"
+#include "sparse_set.h"
+
+namespace ByteE
+{
+
+	class EntityRef
+	{
+	public:
+		using ClusterPointer = Cluster*;
+
+	private:
+		EntityContainer* entities;
+		const ClusterContainer* clusters;
+		SparseContainer* sparse;
+		EntityID id;
+
+		ClusterPointer cluster{ nullptr };
+		Index row{};
+		uint64_t version{};
+		uint64_t epoch{};
+
+	public:
+		EntityRef(EntityContainer& entities, const ClusterContainer& clusters, SparseContainer& sparse, EntityID id)
+			:entities{ &entities }, clusters{ &clusters }, sparse{ &sparse }, id{ id }
+		{
+			resolve();
+		}
+
+		template<typename Type>
+		Type& get()
+		{
+			assert(valid());
+
+			if constexpr (std::is_const_v<Type>)
+			{
+				using Stored = std::remove_const_t<Type>;
+
+				if constexpr (ComponentStorage<Stored>::SPARSE)
+				{
+					return std::as_const(*sparse).findSet<Stored>()->get(id);
+				}
+				else
+				{
+					check();
+					return std::as_const(*cluster).getComponent<Stored>(row);
+				}
+			}
+			else if constexpr (ComponentStorage<Type>::SPARSE)
+			{
+				return sparse->getSet<Type>().get(id);
+			}
+			else
+			{
+				check();
+				return cluster->getComponent<Type>(row);
+			}
+		}
+
+		template<typename Type>
+		void set(Type&& component)
+		{
+			assert(valid());
+
+			if constexpr (ComponentStorage<std::decay_t<Type>>::SPARSE)
+			{
+				sparse->getSet<std::decay_t<Type>>().get(id) = std::forward<Type>(component);
+			}
+			else
+			{
+				check();
+				cluster->setComponent(row, std::forward<Type>(component));
+			}
+		}
+
+		template<typename Type>
+		bool has()
+		{
+			using Stored = std::remove_const_t<Type>;
+
+			if constexpr (ComponentStorage<Stored>::SPARSE)
+			{
+				return sparse->contains<Stored>(id);
+			}
+			else
+			{
+				if (!valid())
+				{
+					return false;
+				}
+
+				check();
+				return cluster && cluster->getSignature().test(Component<Stored>::getID());
+			}
+		}
+
+		EntityID getID() const
+		{
+			return id;
+		}
+
+		bool valid() const
+		{
+			return entities->contains(id);
+		}
+
+	private:
+		void check()
+		{
+			if (!cluster || epoch != clusters->getEpoch() || version != cluster->getVersion())
+			{
+				resolve();
+			}
+		}
+
+		void resolve()
+		{
+			assert(valid());
+			if (!valid())
+			{
+				cluster = nullptr;
+				return;
+			}
+
+			const EntityRecord& record{ entities->getRecord(id) };
+			cluster = record.cluster;
+			row = record.row;
+			epoch = clusters->getEpoch();
+			version = cluster ? cluster->getVersion() : 0;
+		}
+	};
+
+}
+
+#endif
\ No newline at end of file
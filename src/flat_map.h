@@ -0,0 +1,632 @@
+#ifndef B_FLATMAP_H
+#define B_FLATMAP_H
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define B_FLATMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "stair_map.h"
+#include "hash.h"
+#include "type_traits.h"
+
+namespace ByteC
+{
+	using Control = int8_t;
+
+	inline constexpr Control EMPTY_CONTROL{ -128 };
+	inline constexpr size_t GROUP_WIDTH{ 16 };
+
+	template<typename Key, typename Type>
+	struct FlatNode
+	{
+		using Value = Type;
+
+		using Pair = std::pair<Key, Value>;
+
+		Pair pair;
+		size_t hash;
+
+		FlatNode(Key&& key, Value&& value, size_t hash)
+			:pair{ std::move(key),std::move(value) }, hash{ hash }
+		{
+		}
+	};
+
+	class ControlGroup
+	{
+	public:
+		using Mask = uint32_t;
+
+	private:
+#ifdef B_FLATMAP_SSE2
+		__m128i data;
+#else
+		const Control* data;
+#endif
+
+	public:
+		ControlGroup(const Control* position)
+#ifdef B_FLATMAP_SSE2
+			:data{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(position)) }
+#else
+			:data{ position }
+#endif
+		{
+		}
+
+		Mask match(Control tag) const
+		{
+#ifdef B_FLATMAP_SSE2
+			return static_cast<Mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(data, _mm_set1_epi8(tag))));
+#else
+			Mask out{};
+			for (size_t index{}; index < GROUP_WIDTH; ++index)
+			{
+				if (data[index] == tag)
+				{
+					out |= 1U << index;
+				}
+			}
+			return out;
+#endif
+		}
+
+		Mask matchEmpty() const
+		{
+			return match(EMPTY_CONTROL);
+		}
+	};
+
+	template<typename Key, typename Type>
+	class FlatIterator
+	{
+	public:
+		using Value = Type;
+
+		using Pair = std::pair<Key, typename std::remove_const<Value>::type>;
+		using PairReference = std::conditional_t<ByteT::isConst<Value>::value, const Pair&, Pair&>;
+
+		using Node = FlatNode<Key, typename std::remove_const<Value>::type>;
+		using NodePointer = std::conditional_t<ByteT::isConst<Value>::value, const Node*, Node*>;
+
+	private:
+		const Control* controls;
+		NodePointer slots;
+		size_t index;
+		size_t count;
+
+	public:
+		FlatIterator(const Control* controls, NodePointer slots, size_t start, size_t count)
+			:controls{ controls }, slots{ slots }, index{ start }, count{ count }
+		{
+			skip();
+		}
+
+		PairReference operator*()
+		{
+			return slots[index].pair;
+		}
+
+		bool operator==(const FlatIterator& left) const
+		{
+			return index == left.index;
+		}
+
+		bool operator!=(const FlatIterator& left) const
+		{
+			return index != left.index;
+		}
+
+		FlatIterator& operator++()
+		{
+			++index;
+			skip();
+			return *this;
+		}
+
+		FlatIterator operator++(int)
+		{
+			FlatIterator old{ *this };
+			++(*this);
+			return old;
+		}
+
+	private:
+		void skip()
+		{
+			while (index < count && controls[index] == EMPTY_CONTROL)
+			{
+				++index;
+			}
+		}
+	};
+
+	template<
+		typename Key,
+		typename Type,
+		typename Hash = ByteA::Hash<Key>,
+		typename Allocator = std::allocator<FlatNode<Key, Type>>>
+	class FlatMap
+	{
+	public:
+		using Value = Type;
+
+		using Node = FlatNode<Key, Value>;
+		using NodePointer = Node*;
+
+		using AllocatorTraits = std::allocator_traits<Allocator>;
+		using ControlAllocator = typename AllocatorTraits::template rebind_alloc<Control>;
+		using ControlTraits = std::allocator_traits<ControlAllocator>;
+
+		using Iterator = FlatIterator<Key, Value>;
+		using ConstIterator = FlatIterator<Key, const Value>;
+
+		using Result = SearchResult<Key, Value, Node>;
+		using ConstResult = const SearchResult<Key, Value, Node>;
+
+		inline static constexpr size_t MIN_CAPACITY{ GROUP_WIDTH };
+
+	private:
+		Hash hasher;
+		Allocator allocator;
+		Control* controls{ nullptr };
+		NodePointer slots{ nullptr };
+		size_t slotCount{};
+		size_t itemCount{};
+
+	public:
+		FlatMap() = default;
+
+		FlatMap(const Allocator& allocator)
+			:allocator{ allocator }
+		{
+		}
+
+		FlatMap(const FlatMap& left)
+			:hasher{ left.hasher }, allocator{ AllocatorTraits::select_on_container_copy_construction(left.allocator) }
+		{
+			copyFrom(left);
+		}
+
+		FlatMap(FlatMap&& right) noexcept
+			:hasher{ std::move(right.hasher) }, allocator{ std::move(right.allocator) }
+		{
+			steal(right);
+		}
+
+		FlatMap& operator=(const FlatMap& left)
+		{
+			if (this != &left)
+			{
+				clear();
+				release();
+				copyFrom(left);
+			}
+			return *this;
+		}
+
+		FlatMap& operator=(FlatMap&& right) noexcept
+		{
+			if (this == &right)
+			{
+				return *this;
+			}
+
+			clear();
+			release();
+
+			if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value)
+			{
+				allocator = std::move(right.allocator);
+			}
+			else if (allocator != right.allocator)
+			{
+				reserve(right.itemCount);
+				for (size_t index{}; index < right.slotCount; ++index)
+				{
+					if (right.controls[index] != EMPTY_CONTROL)
+					{
+						Node& node{ right.slots[index] };
+						emplaceUnique(std::move(node.pair.first), std::move(node.pair.second), node.hash);
+					}
+				}
+				right.clear();
+				return *this;
+			}
+
+			steal(right);
+			return *this;
+		}
+
+		~FlatMap()
+		{
+			clear();
+			release();
+		}
+
+		void insert(const Key& key, const Value& value)
+		{
+			insert(Key{ key }, Value{ value });
+		}
+
+		void insert(const Key& key, Value&& value)
+		{
+			insert(Key{ key }, std::move(value));
+		}
+
+		void insert(Key&& key, const Value& value)
+		{
+			insert(std::move(key), Value{ value });
+		}
+
+		void insert(Key&& key, Value&& value)
+		{
+			insert(std::move(key), std::move(value), hasher(key));
+		}
+
+		void insert(Key&& key, Value&& value, size_t hashValue)
+		{
+			hashValue = ByteA::fold(hashValue);
+			NodePointer node{ findNode(key, hashValue) };
+
+			if (node)
+			{
+				node->pair.second = std::move(value);
+				return;
+			}
+
+			checkLoad();
+			emplaceUnique(std::move(key), std::move(value), hashValue);
+		}
+
+		Value& at(const Key& key)
+		{
+			return findNode(key, hashKey(key))->pair.second;
+		}
+
+		const Value& at(const Key& key) const
+		{
+			return findNode(key, hashKey(key))->pair.second;
+		}
+
+		[[nodiscard]] Value& operator[](const Key& key)
+		{
+			size_t hashValue{ hashKey(key) };
+			NodePointer node{ findNode(key, hashValue) };
+
+			if (node)
+			{
+				return node->pair.second;
+			}
+
+			checkLoad();
+			return emplaceUnique(Key{ key }, Value{}, hashValue).pair.second;
+		}
+
+		const Value& operator[](const Key& key) const
+		{
+			return at(key);
+		}
+
+		void erase(const Key& key)
+		{
+			NodePointer node{ findNode(key, hashKey(key)) };
+			if (node)
+			{
+				eraseSlot(static_cast<size_t>(node - slots));
+			}
+		}
+
+		Result find(const Key& key)
+		{
+			return findNode(key, hashKey(key));
+		}
+
+		Result find(const Key& key, size_t hashValue)
+		{
+			return findNode(key, ByteA::fold(hashValue));
+		}
+
+		const ConstResult find(const Key& key) const
+		{
+			return findNode(key, hashKey(key));
+		}
+
+		bool contains(const Key& key) const
+		{
+			return findNode(key, hashKey(key)) != nullptr;
+		}
+
+		Iterator begin()
+		{
+			return Iterator{ controls, slots, 0, slotCount };
+		}
+
+		Iterator end()
+		{
+			return Iterator{ controls, slots, slotCount, slotCount };
+		}
+
+		ConstIterator begin() const
+		{
+			return ConstIterator{ controls, slots, 0, slotCount };
+		}
+
+		ConstIterator end() const
+		{
+			return ConstIterator{ controls, slots, slotCount, slotCount };
+		}
+
+		size_t size() const
+		{
+			return itemCount;
+		}
+
+		bool empty() const
+		{
+			return itemCount == 0;
+		}
+
+		size_t tableSize() const
+		{
+			return slotCount;
+		}
+
+		void rehash(size_t newSize)
+		{
+			newSize = std::max(std::bit_ceil(newSize), MIN_CAPACITY);
+			while (itemCount > getMaxLoad(newSize))
+			{
+				newSize *= 2;
+			}
+
+			Control* oldControls{ controls };
+			NodePointer oldSlots{ slots };
+			size_t oldCount{ slotCount };
+
+			allocate(newSize);
+
+			for (size_t index{}; index < oldCount; ++index)
+			{
+				if (oldControls[index] != EMPTY_CONTROL)
+				{
+					Node& node{ oldSlots[index] };
+					size_t target{ findEmpty(node.hash) };
+					AllocatorTraits::construct(allocator, slots + target, std::move(node));
+					setControl(target, getTag(node.hash));
+					AllocatorTraits::destroy(allocator, &node);
+				}
+			}
+
+			deallocate(oldControls, oldSlots, oldCount);
+		}
+
+		void reserve(size_t count)
+		{
+			size_t newSize{ std::max(slotCount, MIN_CAPACITY) };
+			while (count > getMaxLoad(newSize))
+			{
+				newSize *= 2;
+			}
+
+			if (newSize != slotCount)
+			{
+				rehash(newSize);
+			}
+		}
+
+		void clear()
+		{
+			if (!itemCount)
+			{
+				return;
+			}
+
+			if constexpr (!std::is_trivially_destructible_v<Node>)
+			{
+				for (size_t index{}; index < slotCount; ++index)
+				{
+					if (controls[index] != EMPTY_CONTROL)
+					{
+						AllocatorTraits::destroy(allocator, slots + index);
+					}
+				}
+			}
+			std::memset(controls, EMPTY_CONTROL, slotCount + GROUP_WIDTH);
+			itemCount = 0;
+		}
+
+	private:
+		size_t hashKey(const Key& key) const
+		{
+			return ByteA::fold(hasher(key));
+		}
+
+		static Control getTag(size_t hashValue)
+		{
+			return static_cast<Control>(hashValue >> 57);
+		}
+
+		static size_t getMaxLoad(size_t count)
+		{
+			return count - count / 8;
+		}
+
+		size_t getHome(size_t hashValue) const
+		{
+			return hashValue & (slotCount - 1);
+		}
+
+		NodePointer findNode(const Key& key, size_t hashValue) const
+		{
+			if (!slotCount)
+			{
+				return nullptr;
+			}
+
+			Control tag{ getTag(hashValue) };
+			size_t mask{ slotCount - 1 };
+			size_t position{ getHome(hashValue) };
+
+			while (true)
+			{
+				ControlGroup group{ controls + position };
+				ControlGroup::Mask matches{ group.match(tag) };
+
+				while (matches)
+				{
+					size_t index{ (position + std::countr_zero(matches)) & mask };
+					if (slots[index].hash == hashValue && slots[index].pair.first == key)
+					{
+						return slots + index;
+					}
+					matches &= matches - 1;
+				}
+
+				if (group.matchEmpty())
+				{
+					return nullptr;
+				}
+				position = (position + GROUP_WIDTH) & mask;
+			}
+		}
+
+		size_t findEmpty(size_t hashValue) const
+		{
+			size_t mask{ slotCount - 1 };
+			size_t position{ getHome(hashValue) };
+
+			while (true)
+			{
+				ControlGroup::Mask empties{ ControlGroup{ controls + position }.matchEmpty() };
+				if (empties)
+				{
+					return (position + std::countr_zero(empties)) & mask;
+				}
+				position = (position + GROUP_WIDTH) & mask;
+			}
+		}
+
+		Node& emplaceUnique(Key&& key, Value&& value, size_t hashValue)
+		{
+			size_t index{ findEmpty(hashValue) };
+			AllocatorTraits::construct(allocator, slots + index, std::move(key), std::move(value), hashValue);
+			setControl(index, getTag(hashValue));
+			++itemCount;
+			return slots[index];
+		}
+
+		void eraseSlot(size_t hole)
+		{
+			size_t mask{ slotCount - 1 };
+			AllocatorTraits::destroy(allocator, slots + hole);
+
+			size_t next{ (hole + 1) & mask };
+			while (controls[next] != EMPTY_CONTROL)
+			{
+				size_t home{ getHome(slots[next].hash) };
+				if (((next - home) & mask) >= ((next - hole) & mask))
+				{
+					AllocatorTraits::construct(allocator, slots + hole, std::move(slots[next]));
+					AllocatorTraits::destroy(allocator, slots + next);
+					setControl(hole, controls[next]);
+					hole = next;
+				}
+				next = (next + 1) & mask;
+			}
+
+			setControl(hole, EMPTY_CONTROL);
+			--itemCount;
+		}
+
+		void setControl(size_t index, Control control)
+		{
+			controls[index] = control;
+			if (index < GROUP_WIDTH)
+			{
+				controls[slotCount + index] = control;
+			}
+		}
+
+		void checkLoad()
+		{
+			if (itemCount + 1 > getMaxLoad(slotCount))
+			{
+				rehash(slotCount * 2);
+			}
+		}
+
+		void allocate(size_t count)
+		{
+			ControlAllocator controlAllocator{ allocator };
+			controls = ControlTraits::allocate(controlAllocator, count + GROUP_WIDTH);
+			slots = AllocatorTraits::allocate(allocator, count);
+			slotCount = count;
+			std::memset(controls, EMPTY_CONTROL, count + GROUP_WIDTH);
+		}
+
+		void deallocate(Control* oldControls, NodePointer oldSlots, size_t count)
+		{
+			if (!count)
+			{
+				return;
+			}
+
+			ControlAllocator controlAllocator{ allocator };
+			ControlTraits::deallocate(controlAllocator, oldControls, count + GROUP_WIDTH);
+			AllocatorTraits::deallocate(allocator, oldSlots, count);
+		}
+
+		void release()
+		{
+			deallocate(controls, slots, slotCount);
+			controls = nullptr;
+			slots = nullptr;
+			slotCount = 0;
+		}
+
+		void steal(FlatMap& right)
+		{
+			controls = right.controls;
+			slots = right.slots;
+			slotCount = right.slotCount;
+			itemCount = right.itemCount;
+
+			right.controls = nullptr;
+			right.slots = nullptr;
+			right.slotCount = 0;
+			right.itemCount = 0;
+		}
+
+		void copyFrom(const FlatMap& left)
+		{
+			if (!left.slotCount)
+			{
+				return;
+			}
+
+			allocate(left.slotCount);
+			std::memcpy(controls, left.controls, slotCount + GROUP_WIDTH);
+
+			for (size_t index{}; index < slotCount; ++index)
+			{
+				if (controls[index] != EMPTY_CONTROL)
+				{
+					AllocatorTraits::construct(allocator, slots + index, left.slots[index]);
+				}
+			}
+			itemCount = left.itemCount;
+		}
+	};
+}
+
+#endif
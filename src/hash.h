@@ -4,6 +4,10 @@
 #include <cstdint>
 #include <string>
 
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
 namespace ByteA
 {
 
@@ -25,6 +29,31 @@ namespace ByteA
         return stringHash(arg.c_str());
     }
 
+    inline constexpr uint64_t mix(uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    inline uint64_t fold(uint64_t value)
+    {
+        constexpr uint64_t multiplier{ 0x9e3779b97f4a7c15ULL };
+#if defined(__SIZEOF_INT128__)
+        __uint128_t product{ static_cast<__uint128_t>(value) * multiplier };
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        uint64_t high{};
+        uint64_t low{ _umul128(value, multiplier, &high) };
+        return low ^ high;
+#else
+        return mix(value);
+#endif
+    }
+
     template<typename T>
     struct Hash
     {
@@ -1,12 +1,18 @@
 #ifndef B_POOL_H
 #define B_POOL_H
 
+#include <cassert>
 #include <functional>
 #include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "config.h"
 #include "entity_container.h"
 #include "cluster_container.h"
+#include "entity_ref.h"
+#include "sparse_set.h"
 #include "component.h"
 
 namespace ByteE
@@ -17,110 +23,328 @@ namespace ByteE
 	private:
 		EntityContainer entities;
 		ClusterContainer clusters;
+		SparseContainer sparse;
 
 		template<typename... Types>
 		friend class PoolView;
 
+		friend class CommandBuffer;
+
 	public:
+		Pool(MemoryResource* resource = std::pmr::get_default_resource())
+			:entities{ resource }, clusters{ resource }, sparse{ resource }
+		{
+		}
+
+		MemoryResource* getResource() const
+		{
+			return clusters.getResource();
+		}
+
 		EntityID createEntity()
 		{
 			return entities.createEntity();
 		}
 
+		template<typename... Types>
+		std::vector<EntityID> createEntities(size_t count, const Types&... components)
+		{
+			if constexpr (sizeof...(Types) == 0)
+			{
+				return entities.createEntities(count);
+			}
+			else
+			{
+				Signature signature{ ClusterSignatureCreator<Types...>{} };
+				Cluster* cluster{ nullptr };
+				std::vector<EntityID> out;
+
+				if (signature.any())
+				{
+					cluster = &clusters.getCluster(signature);
+					Index firstRow{ static_cast<Index>(cluster->size()) };
+					out = entities.createEntities(count, cluster, firstRow);
+					cluster->pushEntities(out);
+				}
+				else
+				{
+					out = entities.createEntities(count);
+				}
+
+				(pushComponents<Types>(cluster, out, components), ...);
+
+				return out;
+			}
+		}
+
 		void destroyEntity(EntityID id)
 		{
-			Cluster* cluster{ entities.getCluster(id) };
-			if (cluster)
+			if (!entities.contains(id))
 			{
-				cluster->removeEntity(id);
-				clusters.checkCluster(*cluster);
+				return;
 			}
+
+			EntityRecord record{ entities.getRecord(id) };
+			if (record.cluster)
+			{
+				eraseRow(*record.cluster, record.row);
+				clusters.checkCluster(*record.cluster);
+			}
+			sparse.removeEntity(id);
 			entities.removeEntity(id);
 		}
 
-		template<typename Type>
-		void addComponent(EntityID id, Type&& component)
+		template<typename... Query>
+		void destroyAll(const Signature& without = Signature{})
 		{
-			Cluster* oldCluster{entities.getCluster(id)};
+			static_assert(!(ComponentStorage<Query>::SPARSE || ...), "bulk queries match clusters, not sparse components");
 
-			Signature newSignature;
+			ClusterGroup matched{ clusters.getClusters(SignatureCreator<Query...>{}, without) };
 
-			if (oldCluster)
+			for (Cluster* cluster : matched)
 			{
-				newSignature = oldCluster->getSignature();
+				if (cluster->empty())
+				{
+					continue;
+				}
+
+				if (!sparse.empty())
+				{
+					for (EntityID id : cluster->getEntities())
+					{
+						sparse.removeEntity(id);
+					}
+				}
+				entities.removeEntities(cluster->getEntities());
+				cluster->clearEntities();
+				clusters.markIdle(*cluster);
 			}
+			clusters.evict();
+		}
 
-			newSignature.set(Component<Type>::getID());
+		void clear()
+		{
+			clusters.clear();
+			sparse.clear();
+			entities.clear();
+		}
 
-			Cluster& newCluster{clusters.getCluster(newSignature)};
+		void setClusterRetention(size_t budget)
+		{
+			clusters.setRetention(budget);
+		}
 
-			if (oldCluster)
+		void shrinkToFit()
+		{
+			clusters.shrinkToFit();
+		}
+
+		Tick getTick() const
+		{
+			return clusters.getTick();
+		}
+
+		Tick advanceTick()
+		{
+			return clusters.advanceTick();
+		}
+
+		bool contains(EntityID id) const
+		{
+			return entities.contains(id);
+		}
+
+		EntityRef ref(EntityID id)
+		{
+			return EntityRef{ entities, clusters, sparse, id };
+		}
+
+		template<typename Type>
+		void addComponent(EntityID id, Type&& component)
+		{
+			if (!entities.contains(id))
 			{
-				ClusterTraits::carryEntity(*oldCluster, newCluster,id);
-				oldCluster->removeEntity(id);
+				return;
 			}
-			else
+
+			emplaceComponent<std::decay_t<Type>>(id, std::forward<Type>(component));
+		}
+
+		template<typename Type, typename... Args>
+		Type& emplaceComponent(EntityID id, Args&&... args)
+		{
+			assert(entities.contains(id));
+
+			if constexpr (ComponentStorage<Type>::SPARSE)
 			{
-				newCluster.pushEntity(id);
+				return sparse.getSet<Type>().emplace(id, std::forward<Args>(args)...);
 			}
+			else
+			{
+				EntityRecord record{ entities.getRecord(id) };
+				Cluster* oldCluster{ record.cluster };
 
-			newCluster.pushComponent<Type>(std::move(component));
-			entities.setCluster(id, newCluster);
+				if (!oldCluster)
+				{
+					Cluster& newCluster{clusters.getCluster(SignatureCreator<Type>{})};
+					Index row{ newCluster.pushEntity(id) };
+					Type& out{ newCluster.emplaceComponent<Type>(std::forward<Args>(args)...) };
+					entities.setCluster(id, newCluster, row);
+					return out;
+				}
+
+				if (oldCluster->getSignature().test(Component<Type>::getID()))
+				{
+					return oldCluster->assignComponent<Type>(record.row, std::forward<Args>(args)...);
+				}
+
+				ClusterEdge& edge{clusters.getEdge(*oldCluster, Component<Type>::getID())};
+				Cluster& newCluster{*edge.destination};
+
+				Type& out{ newCluster.emplaceComponent<Type>(std::forward<Args>(args)...) };
+				Index row{ ClusterTraits::carryEntity(*oldCluster, edge, record.row) };
+				eraseRow(*oldCluster, record.row);
+
+				entities.setCluster(id, newCluster, row);
 
-			if (oldCluster)
-			{
 				clusters.checkCluster(*oldCluster);
+
+				return out;
 			}
 		}
 
 		template<typename Type>
 		Type& getComponent(EntityID id)
 		{
-			return entities.getCluster(id)->getComponent<Type>(id);
+			assert(entities.contains(id));
+
+			if constexpr (std::is_const_v<Type>)
+			{
+				return std::as_const(*this).getComponent<std::remove_const_t<Type>>(id);
+			}
+			else if constexpr (ComponentStorage<Type>::SPARSE)
+			{
+				return sparse.getSet<Type>().get(id);
+			}
+			else
+			{
+				EntityRecord& record{ entities.getRecord(id) };
+				return record.cluster->getComponent<Type>(record.row);
+			}
 		}
 
 		template<typename Type>
 		const Type& getComponent(EntityID id) const
 		{
-			return entities.getCluster(id)->getComponent<Type>(id);
+			assert(entities.contains(id));
+
+			if constexpr (ComponentStorage<Type>::SPARSE)
+			{
+				return sparse.findSet<Type>()->get(id);
+			}
+			else
+			{
+				const EntityRecord& record{ entities.getRecord(id) };
+				return std::as_const(*record.cluster).getComponent<Type>(record.row);
+			}
 		}
 
 		template<typename Type>
 		void setComponent(EntityID id, Type&& component)
 		{
-			entities.getCluster(id)->setComponent<Type>(id,std::move(component));
+			if (!entities.contains(id))
+			{
+				return;
+			}
+
+			if constexpr (ComponentStorage<std::decay_t<Type>>::SPARSE)
+			{
+				sparse.getSet<std::decay_t<Type>>().get(id) = std::forward<Type>(component);
+			}
+			else
+			{
+				EntityRecord& record{ entities.getRecord(id) };
+				record.cluster->setComponent(record.row, std::forward<Type>(component));
+			}
 		}
 
 		template<typename Type>
 		void removeComponent(EntityID id)
 		{
-			Cluster* oldCluster{ entities.getCluster(id)};
-			
-			Signature newSignature{oldCluster->getSignature()};
-
-			newSignature.set(Component<Type>::getID(), false);
+			if (!entities.contains(id))
+			{
+				return;
+			}
 
-			if (!newSignature.any())
+			if constexpr (ComponentStorage<Type>::SPARSE)
 			{
-				oldCluster->removeEntity(id);
+				SparseSet<Type>* set{ sparse.findSet<Type>() };
+				if (set)
+				{
+					set->remove(id);
+				}
 			}
 			else
 			{
-				Cluster& newCluster{ clusters.getCluster(newSignature) };
+				EntityRecord record{ entities.getRecord(id) };
+				Cluster* oldCluster{ record.cluster };
+
+				if (!oldCluster || !oldCluster->getSignature().test(Component<Type>::getID()))
+				{
+					return;
+				}
+
+				if (oldCluster->componentCount() == 1)
+				{
+					eraseRow(*oldCluster, record.row);
+					entities.resetCluster(id);
+				}
+				else
+				{
+					ClusterEdge& edge{ clusters.getEdge(*oldCluster, Component<Type>::getID()) };
+					Cluster& newCluster{ *edge.destination };
+
+					Index row{ ClusterTraits::carryEntity(*oldCluster, edge, record.row) };
+					eraseRow(*oldCluster, record.row);
+					entities.setCluster(id, newCluster, row);
+				}
+				clusters.checkCluster(*oldCluster);
+			}
+		}
 
-				ClusterTraits::carryEntity(*oldCluster, newCluster, id);
-				oldCluster->removeEntity(id);
-				entities.setCluster(id, newCluster);
+		template<typename... Types, typename... Args>
+		void addComponents(EntityID id, Args&&... components)
+		{
+			if constexpr (sizeof...(Types) == 0)
+			{
+				emplaceComponents<std::decay_t<Args>...>(id, std::forward_as_tuple(std::forward<Args>(components))...);
+			}
+			else
+			{
+				emplaceComponents<Types...>(id, std::forward_as_tuple(std::forward<Args>(components))...);
 			}
-			clusters.checkCluster(*oldCluster);
 		}
 
-		template<typename... Types>
-		void addComponents(EntityID id, Types... components)
+		template<typename... Types, typename... Tuples>
+		void emplaceComponents(EntityID id, Tuples&&... arguments)
 		{
-			Signature newSignature{ SignatureCreator<Types...>{} };
+			static_assert(sizeof...(Types) == sizeof...(Tuples));
 
-			Cluster* oldCluster{entities.getCluster(id)};
+			if (!entities.contains(id))
+			{
+				return;
+			}
+
+			Signature newSignature{ ClusterSignatureCreator<Types...>{} };
+
+			if (!newSignature.any())
+			{
+				(emplaceTuple<Types>(id, nullptr, 0, nullptr, std::forward<Tuples>(arguments)), ...);
+				return;
+			}
+
+			EntityRecord record{ entities.getRecord(id) };
+			Cluster* oldCluster{ record.cluster };
 
 			if (oldCluster)
 			{
@@ -129,30 +353,250 @@ namespace ByteE
 
 			Cluster& newCluster{ clusters.getCluster(newSignature) };
 
+			(emplaceTuple<Types>(id, oldCluster, record.row, &newCluster, std::forward<Tuples>(arguments)), ...);
+
+			if (&newCluster == oldCluster)
+			{
+				return;
+			}
+
+			Index row{};
+
 			if (oldCluster)
 			{
-				ClusterTraits::carryEntity(*oldCluster, newCluster, id);
-				oldCluster->removeEntity(id);
+				row = ClusterTraits::carryEntity(*oldCluster, newCluster, record.row);
 			}
 			else
 			{
-				newCluster.pushEntity(id);
+				row = newCluster.pushEntity(id);
 			}
 
-			(newCluster.pushComponent<Types>(std::move(components)),...);
-
-			entities.setCluster(id, newCluster);
+			entities.setCluster(id, newCluster, row);
 
 			if (oldCluster)
 			{
+				eraseRow(*oldCluster, record.row);
 				clusters.checkCluster(*oldCluster);
 			}
 		}
 
+		template<typename Type, typename... Query>
+		void addComponentToAll(const Type& component)
+		{
+			static_assert(!(ComponentStorage<Query>::SPARSE || ...), "bulk queries match clusters, not sparse components");
+
+			if constexpr (ComponentStorage<Type>::SPARSE)
+			{
+				SparseSet<Type>& set{ sparse.getSet<Type>() };
+				for (Cluster* cluster : clusters.getClusters(SignatureCreator<Query...>{}, Signature{}))
+				{
+					for (EntityID id : cluster->getEntities())
+					{
+						set.emplace(id, component);
+					}
+				}
+			}
+			else
+			{
+				ComponentID componentID{ Component<Type>::getID() };
+				Signature without;
+				without.set(componentID);
+
+				ClusterGroup matched{ clusters.getClusters(SignatureCreator<Query...>{}, without) };
+
+				for (Cluster* cluster : matched)
+				{
+					if (cluster->empty())
+					{
+						continue;
+					}
+
+					Signature signature{ cluster->getSignature() };
+					signature.set(componentID);
+
+					if (!clusters.findCluster(signature))
+					{
+						clusters.resignCluster(*cluster, signature, [&](Cluster& resigned)
+						{
+							resigned.addColumn(componentID, ComponentAccessor::createArray(componentID, resigned.getResource(), resigned.getClock()));
+							resigned.pushComponents<Type>(resigned.size(), component);
+						});
+						continue;
+					}
+
+					ClusterEdge& edge{ clusters.getEdge(*cluster, componentID) };
+					size_t count{ cluster->size() };
+					moveAll(*cluster, edge);
+					edge.destination->pushComponents<Type>(count, component);
+					clusters.markIdle(*cluster);
+				}
+				clusters.evict();
+			}
+		}
+
+		template<typename Type, typename... Query>
+		void removeComponentFromAll()
+		{
+			static_assert(!(ComponentStorage<Query>::SPARSE || ...), "bulk queries match clusters, not sparse components");
+
+			if constexpr (ComponentStorage<Type>::SPARSE)
+			{
+				SparseSet<Type>* set{ sparse.findSet<Type>() };
+				if (!set)
+				{
+					return;
+				}
+
+				if constexpr (sizeof...(Query) == 0)
+				{
+					set->clear();
+				}
+				else
+				{
+					for (Cluster* cluster : clusters.getClusters(SignatureCreator<Query...>{}, Signature{}))
+					{
+						for (EntityID id : cluster->getEntities())
+						{
+							set->remove(id);
+						}
+					}
+				}
+			}
+			else
+			{
+				ComponentID componentID{ Component<Type>::getID() };
+
+				ClusterGroup matched{ clusters.getClusters(SignatureCreator<Type, Query...>{}, Signature{}) };
+
+				for (Cluster* cluster : matched)
+				{
+					if (cluster->empty())
+					{
+						continue;
+					}
+
+					if (cluster->componentCount() == 1)
+					{
+						for (Index row{}; row < cluster->size(); ++row)
+						{
+							entities.resetCluster(cluster->getEntity(row));
+						}
+						cluster->clearEntities();
+						clusters.markIdle(*cluster);
+						continue;
+					}
+
+					Signature signature{ cluster->getSignature() };
+					signature.set(componentID, false);
+
+					if (!clusters.findCluster(signature))
+					{
+						clusters.resignCluster(*cluster, signature, [&](Cluster& resigned)
+						{
+							resigned.removeColumn(componentID);
+						});
+						continue;
+					}
+
+					moveAll(*cluster, clusters.getEdge(*cluster, componentID));
+					clusters.markIdle(*cluster);
+				}
+				clusters.evict();
+			}
+		}
+
 		template<typename Type>
 		bool hasComponent(EntityID id) const
 		{
-			return entities.getCluster(id)->getSignature().test(Component<Type>::getID());
+			if constexpr (ComponentStorage<Type>::SPARSE)
+			{
+				return sparse.contains<Type>(id);
+			}
+			else
+			{
+				Cluster* cluster{ entities.getCluster(id) };
+				return cluster && cluster->getSignature().test(Component<Type>::getID());
+			}
+		}
+
+		template<typename Type>
+		SparseSet<Type>& getSparseSet()
+		{
+			static_assert(ComponentStorage<Type>::SPARSE);
+			return sparse.getSet<Type>();
+		}
+
+	private:
+		template<typename Type, typename Tuple>
+		void emplaceTuple(EntityID id, Cluster* source, Index row, Cluster* destination, Tuple&& arguments)
+		{
+			std::apply([this, id, source, row, destination](auto&&... args)
+			{
+				if constexpr (ComponentStorage<Type>::SPARSE)
+				{
+					sparse.getSet<Type>().emplace(id, std::forward<decltype(args)>(args)...);
+				}
+				else if (source && source->getSignature().test(Component<Type>::getID()))
+				{
+					source->assignComponent<Type>(row, std::forward<decltype(args)>(args)...);
+				}
+				else
+				{
+					destination->emplaceComponent<Type>(std::forward<decltype(args)>(args)...);
+				}
+			}, std::forward<Tuple>(arguments));
+		}
+
+		template<typename Type>
+		void pushComponents(Cluster* cluster, const std::vector<EntityID>& ids, const Type& component)
+		{
+			if constexpr (ComponentStorage<Type>::SPARSE)
+			{
+				SparseSet<Type>& set{ sparse.getSet<Type>() };
+				for (EntityID id : ids)
+				{
+					set.emplace(id, component);
+				}
+			}
+			else
+			{
+				cluster->pushComponents<Type>(ids.size(), component);
+			}
+		}
+
+		void eraseRow(Cluster& cluster, Index row)
+		{
+			EntityID moved{ cluster.removeEntity(row) };
+			if (moved != nullEntity)
+			{
+				entities.setRow(moved, row);
+			}
+		}
+
+		void moveAll(Cluster& cluster, ClusterEdge& edge)
+		{
+			Cluster& destination{ *edge.destination };
+			Index firstRow{ ClusterTraits::carryAll(cluster, edge) };
+
+			for (Index row{}; row < cluster.size(); ++row)
+			{
+				entities.setCluster(cluster.getEntity(row), destination, firstRow + row);
+			}
+
+			cluster.clearEntities();
+		}
+
+		void eraseRows(Cluster& cluster, const Index* rows, size_t count)
+		{
+			cluster.removeEntities(rows, count);
+
+			for (size_t index{}; index < count; ++index)
+			{
+				if (rows[index] < cluster.size())
+				{
+					entities.setRow(cluster.getEntity(rows[index]), rows[index]);
+				}
+			}
 		}
 	};
 
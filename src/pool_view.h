@@ -1,11 +1,15 @@
 #ifndef	B_POOLVIEW_H
 #define B_POOLVIEW_H
 
+#include <algorithm>
+#include <utility>
+
 #include "config.h"
 
 #include "cluster.h"
 #include "cluster_container.h"
 #include "pool.h"
+#include "thread_pool.h"
 
 namespace ByteE
 {
@@ -20,18 +24,25 @@ namespace ByteE
 
 	private:
 		Index index;
+		Index limit{};
 		ClusterGroup* clusters;
 		Cache cache;
 		Index cacheIndex;
+		Tick since;
+		const SparseContainer* sparse;
+		SparseGroup excluded;
 
 	public:
-		PoolIterator(Index index, ClusterGroup& clusterGroup, Index cacheIndex)
-			:index{ index }, clusters{ &clusterGroup }, cacheIndex{cacheIndex}
+		PoolIterator(
+			Index index, 
+			ClusterGroup& clusterGroup, 
+			Index cacheIndex, 
+			Tick since = nullTick, 
+			const SparseContainer* sparse = nullptr, 
+			SparseGroup excluded = {})
+			:index{ index }, clusters{ &clusterGroup }, cacheIndex{cacheIndex}, since{ since }, sparse{ sparse }, excluded{ std::move(excluded) }
 		{
-			if (cacheIndex < clusters->size())
-			{
-				cache = Cache(*clusters->at(cacheIndex));
-			}
+			seek();
 		}
 
 		ComponentGroup operator*()
@@ -43,14 +54,11 @@ namespace ByteE
 		{
 			++index;
 
-			if (index == cache.size())
+			if (index == limit && !seekRun())
 			{
 				index = 0;
 				++cacheIndex;
-				if (cacheIndex != clusters->size())
-				{
-					cache = Cache(*clusters->at(cacheIndex));
-				}
+				seek();
 			}
 
 			return *this;
@@ -65,6 +73,33 @@ namespace ByteE
 		{
 			return !(*this == left);
 		}
+
+	private:
+		void seek()
+		{
+			while (cacheIndex < clusters->size())
+			{
+				cache = Cache(*clusters->at(cacheIndex), since, sparse, excluded);
+				cache.touch();
+				if (seekRun())
+				{
+					return;
+				}
+				index = 0;
+				++cacheIndex;
+			}
+		}
+
+		bool seekRun()
+		{
+			size_t first{ index };
+			size_t last{};
+			bool found{ cache.seekRun(first, last, cache.size()) };
+
+			index = static_cast<Index>(first);
+			limit = static_cast<Index>(last);
+			return found;
+		}
 	};
 
 	template<typename... Types>
@@ -72,24 +107,147 @@ namespace ByteE
 	{
 	public:
 		using Iterator = PoolIterator<Types...>;
+		using Cache = Cluster::Cache<Types...>;
+		using CacheContainer = std::vector<Cache>;
+
+		inline static constexpr size_t PARALLEL_GRAIN{ 4096 };
 
 	private:
-		ClusterGroup clusters;
+		struct ChunkRange
+		{
+			Cache* cache;
+			size_t first;
+			size_t last;
+		};
+
+		using RangeContainer = std::vector<ChunkRange>;
+
+		ClusterGroup* clusters;
+		Tick since;
+		const SparseContainer* sparse;
+		SparseGroup excluded;
+
+		static_assert(sizeof...(Types) == 0 || (!QueryTraits<Types>::SPARSE || ...), "views iterate clusters; iterate a SparseSet directly for sparse-only queries");
 
 	public:
-		PoolView(Pool& pool,const Signature& without=Signature{})
-			:clusters(pool.clusters.getClusters(SignatureCreator<Types...>(), without))
+		PoolView(Pool& pool,const Signature& without=Signature{}, Tick since = nullTick)
+			:clusters{ &pool.clusters.getQuery(ClusterSignatureCreator<typename QueryTraits<Types>::Component...>(), without) }, 
+			since{ since }, 
+			sparse{ &pool.sparse }, 
+			excluded{ pool.sparse.getSets(without) }
+		{
+		}
+
+		PoolView(Pool& pool, Tick since)
+			:PoolView{ pool, Signature{}, since }
 		{
 		}
 
 		Iterator begin()
 		{
-			return Iterator{0,clusters,0};
+			return Iterator{0,*clusters,0,since,sparse,excluded};
 		}
 
 		Iterator end()
 		{
-			return Iterator{ 0,clusters,static_cast<Index>(clusters.size())};
+			return Iterator{ 0,*clusters,static_cast<Index>(clusters->size())};
+		}
+
+		template<typename Function>
+		void forEachChunk(Function&& function)
+		{
+			for (ClusterPointer cluster : *clusters)
+			{
+				Cache cache{ *cluster, since, sparse, excluded };
+				cache.forEachChunk(function);
+			}
+		}
+
+		template<typename Function>
+		void parallelForEachChunk(Function&& function, size_t grain = PARALLEL_GRAIN)
+		{
+			parallelForEachChunk(ThreadPool::global(), function, grain);
+		}
+
+		template<typename Function>
+		void parallelForEachChunk(ThreadPool& threads, Function&& function, size_t grain = PARALLEL_GRAIN)
+		{
+			parallelRun(threads, [&function](Cache& cache, size_t first, size_t last)
+			{
+				cache.forEachChunk(function, first, last);
+			}, grain);
+		}
+
+		template<typename Function>
+		void parallelForEach(Function&& function, size_t grain = PARALLEL_GRAIN)
+		{
+			parallelForEach(ThreadPool::global(), function, grain);
+		}
+
+		template<typename Function>
+		void parallelForEach(ThreadPool& threads, Function&& function, size_t grain = PARALLEL_GRAIN)
+		{
+			parallelRun(threads, [&function](Cache& cache, size_t first, size_t last)
+			{
+				cache.forEach(function, first, last);
+			}, grain);
+		}
+
+	private:
+		template<typename Visit>
+		void parallelRun(ThreadPool& threads, Visit&& visit, size_t grain)
+		{
+			CacheContainer caches;
+			caches.reserve(clusters->size());
+
+			for (ClusterPointer cluster : *clusters)
+			{
+				if (!cluster->empty())
+				{
+					caches.emplace_back(*cluster, since, sparse, excluded);
+					caches.back().touch();
+				}
+			}
+
+			TaskGroup group{ threads };
+			RangeContainer batch;
+			size_t batchSize{};
+
+			for (Cache& cache : caches)
+			{
+				for (size_t first{}; first < cache.size(); first += grain)
+				{
+					size_t last{ std::min(first + grain, cache.size()) };
+					batch.push_back(ChunkRange{ &cache, first, last });
+					batchSize += last - first;
+
+					if (batchSize >= grain)
+					{
+						runBatch(group, std::move(batch), visit);
+						batch = RangeContainer{};
+						batchSize = 0;
+					}
+				}
+			}
+
+			if (!batch.empty())
+			{
+				runBatch(group, std::move(batch), visit);
+			}
+
+			group.wait();
+		}
+
+		template<typename Visit>
+		static void runBatch(TaskGroup& group, RangeContainer batch, Visit& visit)
+		{
+			group.run([batch{ std::move(batch) }, &visit]()
+			{
+				for (const ChunkRange& range : batch)
+				{
+					visit(*range.cache, range.first, range.last);
+				}
+			});
 		}
 	};
 
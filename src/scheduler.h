@@ -0,0 +1,143 @@
+#ifndef B_SCHEDULER_H
+#define B_SCHEDULER_H
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "config.h"
+#include "signature.h"
+#include "pool.h"
+#include "pool_view.h"
+#include "command_buffer.h"
+#include "thread_pool.h"
+
+namespace ByteE
+{
+
+	template<typename... Types>
+	struct Read : SignatureCreator<Types...>
+	{
+	};
+
+	template<typename... Types>
+	struct Write : SignatureCreator<Types...>
+	{
+	};
+
+	template<typename Reads, typename Writes>
+	struct SystemAccess;
+
+	template<typename... Reads, typename... Writes>
+	struct SystemAccess<Read<Reads...>, Write<Writes...>>
+	{
+		using View = PoolView<const Reads..., Writes...>;
+	};
+
+	class Scheduler
+	{
+	public:
+		using Function = std::function<void(Pool&, CommandBuffer&)>;
+
+		struct System
+		{
+			Function function;
+			Signature reads;
+			Signature writes;
+			size_t stage{};
+			CommandBuffer commands;
+		};
+
+		using SystemContainer = std::vector<System>;
+		using Stage = std::vector<size_t>;
+		using StageContainer = std::vector<Stage>;
+
+	private:
+		SystemContainer systems;
+		StageContainer stages;
+
+	public:
+		template<typename Reads, typename Writes, typename Type>
+		void addSystem(Type&& function)
+		{
+			using View = typename SystemAccess<Reads, Writes>::View;
+
+			Function bound{ [function{ std::forward<Type>(function) }](Pool& pool, CommandBuffer& commands) mutable
+			{
+				View view{ pool };
+				function(view, commands);
+			} };
+
+			System system{ std::move(bound), Reads{}, Writes{}, 0, CommandBuffer{} };
+
+			for (const System& other : systems)
+			{
+				if (conflict(other, system))
+				{
+					system.stage = std::max(system.stage, other.stage + 1);
+				}
+			}
+
+			if (system.stage == stages.size())
+			{
+				stages.emplace_back();
+			}
+
+			stages[system.stage].push_back(systems.size());
+			systems.push_back(std::move(system));
+		}
+
+		void run(Pool& pool)
+		{
+			run(ThreadPool::global(), pool);
+		}
+
+		void run(ThreadPool& threads, Pool& pool)
+		{
+			for (const Stage& stage : stages)
+			{
+				if (stage.size() == 1)
+				{
+					System& system{ systems[stage.front()] };
+					system.function(pool, system.commands);
+				}
+				else
+				{
+					TaskGroup group{ threads };
+					for (size_t index : stage)
+					{
+						System* system{ &systems[index] };
+						group.run([system, &pool]() { system->function(pool, system->commands); });
+					}
+					group.wait();
+				}
+
+				for (size_t index : stage)
+				{
+					systems[index].commands.flush(pool);
+				}
+			}
+		}
+
+		size_t stageCount() const
+		{
+			return stages.size();
+		}
+
+		size_t systemCount() const
+		{
+			return systems.size();
+		}
+
+	private:
+		static bool conflict(const System& left, const System& right)
+		{
+			return left.writes.match(right.reads) ||
+				left.writes.match(right.writes) ||
+				right.writes.match(left.reads);
+		}
+	};
+
+}
+
+#endif
\ No newline at end of file
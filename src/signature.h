@@ -154,6 +154,27 @@ namespace ByteE
 			return out;
 		}
 	};
+
+	template<typename... Types>
+	struct ClusterSignatureCreator
+	{
+		operator Signature() const
+		{
+			Signature out;
+			(set<Types>(out), ...);
+			return out;
+		}
+
+	private:
+		template<typename Type>
+		static void set(Signature& out)
+		{
+			if constexpr (!ComponentStorage<Type>::SPARSE)
+			{
+				out.set(Component<Type>::getID());
+			}
+		}
+	};
 }
 
 namespace ByteA
@@ -161,14 +182,17 @@ namespace ByteA
 	template<>
 	struct Hash<ByteE::Signature>
 	{
-		size_t operator()(const ByteE::Signature& signature)
+		size_t operator()(const ByteE::Signature& signature) const
 		{
 			constexpr size_t elementCount{(ByteE::MAX_COMPONENT_COUNT/64) + 1};
 			
 			size_t hash{};
 			for (size_t i{}; i < elementCount; ++i)
 			{
-				hash += (i + 1) * signature.data[i];
+				if (signature.data[i])
+				{
+					hash ^= mix(signature.data[i] + (i + 1) * 0x9e3779b97f4a7c15ULL);
+				}
 			}
 			return hash;
 		}
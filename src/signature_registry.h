@@ -0,0 +1,100 @@
+#ifndef B_SIGNATUREREGISTRY_H
+#define B_SIGNATUREREGISTRY_H
+
+#include <vector>
+
+#include "stair_vector.h"
+#include "stair_map.h"
+#include "signature.h"
+
+#include "config.h"
+
+namespace ByteE
+{
+	struct SignatureEntry
+	{
+		using ComponentList = std::vector<ComponentID, Allocator<ComponentID>>;
+
+		SignatureID id;
+		Signature signature;
+		size_t hash;
+		ComponentList components;
+	};
+
+	class SignatureRegistry
+	{
+	public:
+		using Container = ByteC::StairVector<SignatureEntry, Allocator<SignatureEntry>>;
+		using IndexContainer = ByteC::StairMap<
+			Signature,
+			SignatureID,
+			ByteA::Hash<Signature>,
+			Allocator<ByteC::MapNode<Signature, SignatureID>>>;
+
+	private:
+		Container entries;
+		IndexContainer index;
+
+	public:
+		SignatureRegistry(MemoryResource* resource = std::pmr::get_default_resource())
+			:entries{ resource }, index{ resource }
+		{
+			intern(Signature{});
+		}
+
+		SignatureID intern(const Signature& signature)
+		{
+			size_t hash{ ByteA::Hash<Signature>{}(signature) };
+			auto result{ index.find(signature, hash) };
+
+			if (result.valid())
+			{
+				return result.get();
+			}
+
+			SignatureID id{ static_cast<SignatureID>(entries.size()) };
+			const auto& components{ signature.query() };
+			entries.pushBack(SignatureEntry{
+				id,
+				signature,
+				hash,
+				SignatureEntry::ComponentList{ components.begin(), components.end(), entries.getAllocator() } });
+			index.insert(Signature{ signature }, SignatureID{ id }, hash);
+
+			return id;
+		}
+
+		SignatureID find(const Signature& signature) const
+		{
+			auto result{ index.find(signature) };
+
+			if (result.valid())
+			{
+				return result.get();
+			}
+			return nullSignature;
+		}
+
+		const SignatureEntry& get(SignatureID id) const
+		{
+			return entries.at(id);
+		}
+
+		const Signature& getSignature(SignatureID id) const
+		{
+			return entries.at(id).signature;
+		}
+
+		const SignatureEntry::ComponentList& getComponents(SignatureID id) const
+		{
+			return entries.at(id).components;
+		}
+
+		size_t size() const
+		{
+			return entries.size();
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,278 @@
+#ifndef B_SPARSESET_H
+#define B_SPARSESET_H
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "stair_vector.h"
+#include "signature.h"
+#include "component.h"
+
+#include "config.h"
+
+namespace ByteE
+{
+
+	class ISparseSet
+	{
+	public:
+		virtual ~ISparseSet() = default;
+
+		virtual bool contains(EntityID id) const = 0;
+
+		virtual void remove(EntityID id) = 0;
+
+		virtual void clear() = 0;
+
+		virtual size_t size() const = 0;
+	};
+
+	using SparseGroup = std::vector<const ISparseSet*>;
+
+	template<typename Type>
+	class SparseSet : public ISparseSet
+	{
+	public:
+		using Container = ByteC::StairVector<Type, Allocator<Type>>;
+		using IDContainer = ByteC::StairVector<EntityID, Allocator<EntityID>>;
+		using IndexContainer = std::vector<Index, Allocator<Index>>;
+
+		inline static constexpr Index NO_INDEX{ UINT32_MAX };
+
+	private:
+		Container components;
+		IDContainer ids;
+		IndexContainer indices;
+
+	public:
+		SparseSet(MemoryResource* resource = std::pmr::get_default_resource())
+			:components{ Allocator<Type>{ resource } }, ids{ Allocator<EntityID>{ resource } }, indices{ resource }
+		{
+		}
+
+		template<typename... Args>
+		Type& emplace(EntityID id, Args&&... args)
+		{
+			if (contains(id))
+			{
+				return assign(indices[getSlot(id)], std::forward<Args>(args)...);
+			}
+
+			Index slot{ getSlot(id) };
+			if (slot >= indices.size())
+			{
+				indices.resize(slot + 1, NO_INDEX);
+			}
+
+			Type& out{ components.emplaceBack(std::forward<Args>(args)...) };
+			ids.pushBack(id);
+			indices[slot] = static_cast<Index>(ids.size() - 1);
+
+			return out;
+		}
+
+		bool contains(EntityID id) const override
+		{
+			Index slot{ getSlot(id) };
+			return slot < indices.size() && indices[slot] != NO_INDEX && ids.at(indices[slot]) == id;
+		}
+
+		void remove(EntityID id) override
+		{
+			if (!contains(id))
+			{
+				return;
+			}
+
+			Index slot{ getSlot(id) };
+			Index index{ indices[slot] };
+
+			if (index != ids.size() - 1)
+			{
+				EntityID last{ ids.back() };
+				ids.at(index) = last;
+				indices[getSlot(last)] = index;
+			}
+			components.swapRemove(index);
+			ids.popBack();
+			indices[slot] = NO_INDEX;
+		}
+
+		Type& get(EntityID id)
+		{
+			return components.at(indices[getSlot(id)]);
+		}
+
+		const Type& get(EntityID id) const
+		{
+			return components.at(indices[getSlot(id)]);
+		}
+
+		Type* find(EntityID id)
+		{
+			if (contains(id))
+			{
+				return &get(id);
+			}
+			return nullptr;
+		}
+
+		const IDContainer& getEntities() const
+		{
+			return ids;
+		}
+
+		template<typename Function>
+		void forEach(Function&& function)
+		{
+			for (size_t index{}; index < ids.size(); ++index)
+			{
+				function(ids.at(index), components.at(index));
+			}
+		}
+
+		size_t size() const override
+		{
+			return ids.size();
+		}
+
+		bool empty() const
+		{
+			return ids.empty();
+		}
+
+		void clear() override
+		{
+			components.clear();
+			ids.clear();
+			indices.clear();
+		}
+
+	private:
+		template<typename... Args>
+		Type& assign(Index index, Args&&... args)
+		{
+			Type& out{ components.at(index) };
+			if constexpr (sizeof...(Args) == 1 && (std::is_same_v<std::decay_t<Args>, Type> && ...))
+			{
+				((out = std::forward<Args>(args)), ...);
+			}
+			else
+			{
+				out = Type(std::forward<Args>(args)...);
+			}
+			return out;
+		}
+
+		static Index getSlot(EntityID id)
+		{
+			return static_cast<Index>(id);
+		}
+	};
+
+	class SparseContainer
+	{
+	public:
+		using SetBase = std::unique_ptr<ISparseSet>;
+		using Container = std::vector<SetBase, Allocator<SetBase>>;
+
+	private:
+		MemoryResource* resource;
+		Container sets;
+
+	public:
+		SparseContainer(MemoryResource* resource = std::pmr::get_default_resource())
+			:resource{ resource }, sets{ resource }
+		{
+		}
+
+		template<typename Type>
+		SparseSet<Type>& getSet()
+		{
+			ComponentID componentID{ Component<Type>::getID() };
+			if (componentID >= sets.size())
+			{
+				sets.resize(componentID + 1);
+			}
+			if (!sets[componentID])
+			{
+				sets[componentID] = std::make_unique<SparseSet<Type>>(resource);
+			}
+			return static_cast<SparseSet<Type>&>(*sets[componentID]);
+		}
+
+		template<typename Type>
+		SparseSet<Type>* findSet() const
+		{
+			return static_cast<SparseSet<Type>*>(findSet(Component<Type>::getID()));
+		}
+
+		ISparseSet* findSet(ComponentID component) const
+		{
+			if (component < sets.size())
+			{
+				return sets[component].get();
+			}
+			return nullptr;
+		}
+
+		SparseGroup getSets(const Signature& signature) const
+		{
+			SparseGroup out;
+			if (sets.empty() || !signature.any())
+			{
+				return out;
+			}
+
+			for (ComponentID component : signature.query())
+			{
+				ISparseSet* set{ findSet(component) };
+				if (set)
+				{
+					out.push_back(set);
+				}
+			}
+			return out;
+		}
+
+		template<typename Type>
+		bool contains(EntityID id) const
+		{
+			const ISparseSet* set{ findSet(Component<Type>::getID()) };
+			return set && set->contains(id);
+		}
+
+		void removeEntity(EntityID id)
+		{
+			for (SetBase& set : sets)
+			{
+				if (set)
+				{
+					set->remove(id);
+				}
+			}
+		}
+
+		void clear()
+		{
+			for (SetBase& set : sets)
+			{
+				if (set)
+				{
+					set->clear();
+				}
+			}
+		}
+
+		bool empty() const
+		{
+			return sets.empty();
+		}
+	};
+
+}
+
+#endif
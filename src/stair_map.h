@@ -1,16 +1,31 @@
 #ifndef B_STAIRMAP_H
 #define	B_STAIRMAP_H
 
+#include <algorithm>
 #include <memory>
 #include <utility>
+#include <tuple>
 #include <vector>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
 #include "stair_vector.h"
 #include "hash.h"
 #include "type_traits.h"
 
 namespace ByteC
 {
+	inline void prefetch(const void* address)
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+		__builtin_prefetch(address);
+#endif
+	}
+
 	template<typename Key,typename Type>
 	struct MapNode
 	{
@@ -25,8 +40,13 @@ namespace ByteC
 		NextPointer next{ nullptr };
 		size_t hash;
 
-		MapNode(Key&& key, Value&& value, size_t hash)
-			:pair{ std::move(key),std::move(value) }, hash{hash}
+		template<typename KeyType, typename... Args>
+		MapNode(std::piecewise_construct_t, size_t hash, KeyType&& key, Args&&... args)
+			:pair{ 
+				std::piecewise_construct, 
+				std::forward_as_tuple(std::forward<KeyType>(key)), 
+				std::forward_as_tuple(std::forward<Args>(args)...) }, 
+			hash{ hash }
 		{
 		}
 	};
@@ -66,6 +86,11 @@ namespace ByteC
 
 		[[maybe_unused]] NodePointer remove(const Key& key, size_t hashKey)
 		{
+			if (!head)
+			{
+				return nullptr;
+			}
+
 			if (head->hash == hashKey && head->pair.first == key)
 			{
 				NodePointer out{ head };
@@ -87,26 +112,37 @@ namespace ByteC
 			return nullptr;
 		}
 
-		void setNode(const Key& key, size_t hashKey, NodePointer value)
+		bool replace(NodePointer from, NodePointer to)
 		{
-			if (head->hash == hashKey && head->pair.first == key)
+			if (head == from)
 			{
-				value->next = head;
-				head = value;
-				return;
+				head = to;
+				return true;
 			}
 
 			NodePointer iterator{ head };
-			while (iterator->next)
+			while (iterator)
 			{
-				if (iterator->next->hash == hashKey && iterator->next->pair.first == key)
+				if (iterator->next == from)
 				{
-					value->next = iterator->next;
-					iterator->next = value;
-					return;
+					iterator->next = to;
+					return true;
 				}
 				iterator = iterator->next;
 			}
+			return false;
+		}
+
+		NodePointer front() const
+		{
+			return head;
+		}
+
+		NodePointer release()
+		{
+			NodePointer out{ head };
+			head = nullptr;
+			return out;
 		}
 
 	private:
@@ -125,7 +161,10 @@ namespace ByteC
 		}
 	};
 
-	template<typename Key, typename Type>
+	template<
+		typename Key,
+		typename Type,
+		typename Allocator = std::allocator<MapNode<Key, typename std::remove_const<Type>::type>>>
 	class MapIterator
 	{
 	public:
@@ -139,8 +178,8 @@ namespace ByteC
 
 		using StairVector = std::conditional_t<
 			ByteT::isConst<Value>::value,
-			const ByteC::StairVector<Node>, 
-			ByteC::StairVector<Node>>;
+			const ByteC::StairVector<Node, Allocator>, 
+			ByteC::StairVector<Node, Allocator>>;
 		using StairVectorPointer = StairVector*;
 
 	private:
@@ -176,20 +215,20 @@ namespace ByteC
 
 		MapIterator operator++(int)
 		{
-			MapIterator<Key,Value> old{ *this };
+			MapIterator old{ *this };
 			++index;
 			return old;
 		}
 	};
 
-	template<typename Key, typename Type>
+	template<typename Key, typename Type, typename NodeType = MapNode<Key, Type>>
 	class SearchResult
 	{
 	public:
 		using Value = Type;
 		using ValuePointer = Value*;
 
-		using Node = MapNode<Key, Type>;
+		using Node = NodeType;
 		using NodePointer = Node*;
 
 	private:
@@ -237,6 +276,144 @@ namespace ByteC
 		}
 	};
 
+	template<typename Bucket, typename Allocator>
+	class BucketTable
+	{
+	public:
+		using AllocatorTraits = std::allocator_traits<Allocator>;
+		using ChunkAllocator = typename AllocatorTraits::template rebind_alloc<Bucket*>;
+		using ChunkContainer = std::vector<Bucket*, ChunkAllocator>;
+
+		inline static constexpr size_t CHUNK_SHIFT{ 13 };
+		inline static constexpr size_t CHUNK_SIZE{ size_t{ 1 } << CHUNK_SHIFT };
+		inline static constexpr size_t CHUNK_MASK{ CHUNK_SIZE - 1 };
+
+	private:
+		Allocator allocator;
+		ChunkContainer chunks;
+		size_t bucketCount{};
+
+	public:
+		BucketTable(const Allocator& allocator = Allocator{})
+			:allocator{ allocator }, chunks{ ChunkAllocator{ allocator } }
+		{
+		}
+
+		BucketTable(size_t count, const Allocator& allocator)
+			:BucketTable{ allocator }
+		{
+			allocate(count);
+			for (size_t index{}; index < count; ++index)
+			{
+				initialize(index);
+			}
+		}
+
+		BucketTable(const BucketTable& left) = delete;
+
+		BucketTable(BucketTable&& right) noexcept
+			:allocator{ std::move(right.allocator) }, chunks{ ChunkAllocator{ allocator } }
+		{
+			steal(right);
+		}
+
+		BucketTable& operator=(const BucketTable& left) = delete;
+
+		BucketTable& operator=(BucketTable&& right) noexcept
+		{
+			release();
+			if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value)
+			{
+				allocator = std::move(right.allocator);
+			}
+			steal(right);
+			return *this;
+		}
+
+		~BucketTable()
+		{
+			release();
+		}
+
+		void allocate(size_t count)
+		{
+			release();
+			chunks.assign((count + CHUNK_MASK) >> CHUNK_SHIFT, nullptr);
+			bucketCount = count;
+		}
+
+		void initialize(size_t index)
+		{
+			size_t chunk{ index >> CHUNK_SHIFT };
+			if (!chunks[chunk])
+			{
+				chunks[chunk] = AllocatorTraits::allocate(allocator, getChunkSize(chunk));
+			}
+			AllocatorTraits::construct(allocator, chunks[chunk] + (index & CHUNK_MASK));
+		}
+
+		void releaseChunk(size_t index)
+		{
+			size_t chunk{ index >> CHUNK_SHIFT };
+			if (chunks[chunk])
+			{
+				AllocatorTraits::deallocate(allocator, chunks[chunk], getChunkSize(chunk));
+				chunks[chunk] = nullptr;
+			}
+		}
+
+		void release()
+		{
+			for (size_t chunk{}; chunk < chunks.size(); ++chunk)
+			{
+				if (chunks[chunk])
+				{
+					AllocatorTraits::deallocate(allocator, chunks[chunk], getChunkSize(chunk));
+				}
+			}
+			chunks.clear();
+			bucketCount = 0;
+		}
+
+		Bucket& operator[](size_t index)
+		{
+			return chunks[index >> CHUNK_SHIFT][index & CHUNK_MASK];
+		}
+
+		const Bucket& operator[](size_t index) const
+		{
+			return chunks[index >> CHUNK_SHIFT][index & CHUNK_MASK];
+		}
+
+		size_t size() const
+		{
+			return bucketCount;
+		}
+
+		bool empty() const
+		{
+			return bucketCount == 0;
+		}
+
+		Allocator getAllocator() const
+		{
+			return allocator;
+		}
+
+	private:
+		size_t getChunkSize(size_t chunk) const
+		{
+			return std::min(CHUNK_SIZE, bucketCount - (chunk << CHUNK_SHIFT));
+		}
+
+		void steal(BucketTable& right)
+		{
+			chunks.swap(right.chunks);
+			bucketCount = right.bucketCount;
+			right.bucketCount = 0;
+		}
+	};
+
 	template<
 		typename Key,
 		typename Type,
@@ -251,31 +428,43 @@ namespace ByteC
 		using Node = MapNode<Key,Value>;
 		using NodePointer = Node*;
 
-		using BucketArray = std::vector<Bucket>;
+		using BucketAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Bucket>;
+		using BucketArray = BucketTable<Bucket, BucketAllocator>;
 		using NodeArray = StairVector<Node, Allocator>;
 
-		using Iterator = MapIterator<Key,Value>;
-		using ConstIterator = MapIterator<Key,const Value>;
+		using Iterator = MapIterator<Key,Value,Allocator>;
+		using ConstIterator = MapIterator<Key,const Value,Allocator>;
 
 		using Result = SearchResult<Key, Value>;
 		using ConstResult = const SearchResult<Key, Value>;
 
 		inline static constexpr double MAX_LOAD{ 0.9 };
-		inline static constexpr double MIN_LOAD{ 0.1 };
+		inline static constexpr size_t PREFETCH_DISTANCE{ 16 };
+		inline static constexpr size_t NODE_RETENTION{ ArrayContainer<Node>::MAX_ARRAYS };
 
 	private:
 		Hash hasher;
 		NodeArray nodeArray;
 		BucketArray bucketArray;
+		BucketArray oldBuckets;
+		size_t migrated{};
 
 	public:
-		StairMap(size_t tableSize = 2)
-			:bucketArray{ tableSize }
+		StairMap(size_t tableSize = 2, const Allocator& allocator = Allocator{})
+			:nodeArray{ allocator }, bucketArray{ tableSize, BucketAllocator{ allocator } }, oldBuckets{ BucketAllocator{ allocator } }
+		{
+			nodeArray.setRetention(NODE_RETENTION);
+		}
+
+		StairMap(const Allocator& allocator)
+			:StairMap{ 2, allocator }
 		{
 		}
 
 		StairMap(const StairMap& left)
-			:nodeArray{ left.nodeArray }
+			:nodeArray{ left.nodeArray },
+			bucketArray{ BucketAllocator{ nodeArray.getAllocator() } },
+			oldBuckets{ BucketAllocator{ nodeArray.getAllocator() } }
 		{
 			rehash(left.tableSize());
 		}
@@ -289,7 +478,24 @@ namespace ByteC
 			return *this;
 		}
 
-		StairMap& operator=(StairMap&& right) noexcept = default;
+		StairMap& operator=(StairMap&& right) noexcept
+		{
+			bool shared{ nodeArray.getAllocator() == right.nodeArray.getAllocator() };
+			nodeArray = std::move(right.nodeArray);
+
+			if (shared)
+			{
+				bucketArray = std::move(right.bucketArray);
+				oldBuckets = std::move(right.oldBuckets);
+				migrated = right.migrated;
+			}
+			else
+			{
+				rehash(right.tableSize());
+				right.clear();
+			}
+			return *this;
+		}
 
 		~StairMap() = default;
 
@@ -310,40 +516,42 @@ namespace ByteC
 
 		void insert(Key&& key, Value&& value)
 		{
-			size_t hashValue{ hasher(key) };
-			nodeArray.pushBack(Node{ std::move(key),std::move(value), hashValue });
-			bucketArray[hashValue % bucketArray.size()].pushFront(&nodeArray.back());
-			checkLoad();
+			insert(std::move(key), std::move(value), hasher(key));
 		}
 
-		Value& at(const Key& key)
+		void insert(Key&& key, Value&& value, size_t hashValue)
 		{
-			size_t hashValue{ hasher(key) };
-			return bucketArray[hashValue % tableSize()].find(key,hashValue)->pair.second;
+			Node& node{ nodeArray.emplaceBack(std::piecewise_construct, hashValue, std::move(key), std::move(value)) };
+			getBucket(hashValue).pushFront(&node);
+			checkLoad();
 		}
 
-		const Value& at(const Key& key) const
+		template<typename... Args>
+		std::pair<Result, bool> tryEmplace(const Key& key, Args&&... args)
 		{
-			size_t hashValue{ hasher(key) };
-			return bucketArray.at(hashValue % tableSize()).find(key, hashValue)->pair.second;
+			return emplaceNode(key, hasher(key), std::forward<Args>(args)...);
 		}
 
-		[[nodiscard]] Value& operator[](const Key& key)
+		template<typename... Args>
+		std::pair<Result, bool> tryEmplace(Key&& key, Args&&... args)
 		{
 			size_t hashValue{ hasher(key) };
-			NodePointer out{ bucketArray[hashValue % tableSize()].find(key,hashValue) };
-			if (out)
-			{
-				return out->pair.second;
-			}
+			return emplaceNode(std::move(key), hashValue, std::forward<Args>(args)...);
+		}
 
-			nodeArray.pushBack(Node{ Key{key}, Value{}, hashValue});
-			out = &nodeArray.back();
-			bucketArray[hashValue % bucketArray.size()].pushFront(out);
+		Value& at(const Key& key)
+		{
+			return findNode(key, hasher(key))->pair.second;
+		}
 
-			checkLoad();
+		const Value& at(const Key& key) const
+		{
+			return findNode(key, hasher(key))->pair.second;
+		}
 
-			return out->pair.second;
+		[[nodiscard]] Value& operator[](const Key& key)
+		{
+			return *tryEmplace(key).first;
 		}
 
 		const Value& operator[](const Key& key) const
@@ -354,33 +562,41 @@ namespace ByteC
 		void erase(const Key& key)
 		{
 			size_t hashValue{ hasher(key) };
-			NodePointer left{ bucketArray[hashValue % tableSize()].remove(key, hashValue) };
+			NodePointer left{ getBucket(hashValue).remove(key, hashValue) };
+			if (!left)
+			{
+				return;
+			}
 			NodePointer right{ &nodeArray.back() };
 
-			if (left->pair.first != right->pair.first)
+			if (left != right)
 			{
-				bucketArray[right->hash % tableSize()].setNode(right->pair.first,right->hash,left);
-				std::swap(*left, *right);
+				getBucket(right->hash).replace(right, left);
+				*left = std::move(*right);
 			}
 			nodeArray.popBack();
+
+			step();
 		}
 
 		Result find(const Key& key)
 		{
-			size_t hashValue{ hasher(key) };
-			return bucketArray[hashValue % tableSize()].find(key,hashValue);
+			return findNode(key, hasher(key));
+		}
+
+		Result find(const Key& key, size_t hashValue)
+		{
+			return findNode(key, hashValue);
 		}
 
 		const ConstResult find(const Key& key) const
 		{
-			size_t hashValue{ hasher(key) };
-			return bucketArray.at(hashValue % tableSize()).find(key, hashValue);
+			return findNode(key, hasher(key));
 		}
 
 		bool contains(const Key& key) const
 		{
-			size_t hashValue{hasher(key)};
-			return bucketArray[hashValue % tableSize()].contains(key,hashValue);
+			return findNode(key, hasher(key)) != nullptr;
 		}
 
 		Iterator begin()
@@ -418,34 +634,200 @@ namespace ByteC
 			return bucketArray.size();
 		}
 
+		bool rehashing() const
+		{
+			return !oldBuckets.empty();
+		}
+
 		void rehash(size_t newSize)
 		{
-			BucketArray newBuckets{ newSize };
+			BucketArray newBuckets{ newSize, bucketArray.getAllocator() };
 			for (Node& node : nodeArray)
 			{
 				size_t newPosition{ node.hash % newSize };
 				newBuckets[newPosition].pushFront(&node);
 			}
 			bucketArray = std::move(newBuckets);
+			oldBuckets.release();
+			migrated = 0;
+		}
+
+		void reserve(size_t count)
+		{
+			nodeArray.reserve(count);
+
+			size_t newSize{ tableSize() };
+			while (count / static_cast<double>(newSize) > MAX_LOAD)
+			{
+				newSize *= 2;
+			}
+
+			if (newSize != tableSize())
+			{
+				rehash(newSize);
+			}
 		}
 
 		void clear()
 		{
-			bucketArray.clear();
+			bucketArray = BucketArray{ 2, bucketArray.getAllocator() };
+			oldBuckets.release();
+			migrated = 0;
 			nodeArray.clear();
+			nodeArray.shrinkToFit();
+		}
+
+		void shrinkToFit()
+		{
+			nodeArray.shrinkToFit();
+
+			size_t newSize{ 2 };
+			while (nodeArray.size() / static_cast<double>(newSize) > MAX_LOAD)
+			{
+				newSize *= 2;
+			}
+
+			if (newSize != tableSize() || rehashing())
+			{
+				rehash(newSize);
+			}
 		}
 
 	private:
+		NodePointer findNode(const Key& key, size_t hashValue) const
+		{
+			return getBucket(hashValue).find(key, hashValue);
+		}
+
+		template<typename KeyType, typename... Args>
+		std::pair<Result, bool> emplaceNode(KeyType&& key, size_t hashValue, Args&&... args)
+		{
+			NodePointer out{ findNode(key, hashValue) };
+			if (out)
+			{
+				return { out, false };
+			}
+
+			out = &nodeArray.emplaceBack(
+				std::piecewise_construct, 
+				hashValue, 
+				std::forward<KeyType>(key), 
+				std::forward<Args>(args)...);
+			getBucket(hashValue).pushFront(out);
+
+			checkLoad();
+
+			return { out, true };
+		}
+
+		Bucket& getBucket(size_t hashValue)
+		{
+			size_t index{ hashValue % bucketArray.size() };
+			if (rehashing())
+			{
+				size_t oldIndex{ index < oldBuckets.size() ? index : index - oldBuckets.size() };
+				if (oldIndex >= migrated)
+				{
+					return oldBuckets[oldIndex];
+				}
+			}
+			return bucketArray[index];
+		}
+
+		const Bucket& getBucket(size_t hashValue) const
+		{
+			size_t index{ hashValue % bucketArray.size() };
+			if (rehashing())
+			{
+				size_t oldIndex{ index < oldBuckets.size() ? index : index - oldBuckets.size() };
+				if (oldIndex >= migrated)
+				{
+					return oldBuckets[oldIndex];
+				}
+			}
+			return bucketArray[index];
+		}
+
+		void beginRehash(size_t newSize)
+		{
+			if (rehashing())
+			{
+				migrate(oldBuckets.size());
+			}
+
+			oldBuckets = std::move(bucketArray);
+			bucketArray.allocate(newSize);
+			migrated = 0;
+		}
+
+		void migrate(size_t bucketCount)
+		{
+			size_t oldSize{ oldBuckets.size() };
+			size_t newSize{ bucketArray.size() };
+			size_t scanned{};
+
+			while (scanned < bucketCount && migrated < oldSize)
+			{
+				bucketArray.initialize(migrated);
+				bucketArray.initialize(migrated + oldSize);
+
+				if (migrated + PREFETCH_DISTANCE < oldSize)
+				{
+					prefetch(oldBuckets[migrated + PREFETCH_DISTANCE].front());
+				}
+				NodePointer node{ oldBuckets[migrated].release() };
+				while (node)
+				{
+					NodePointer next{ node->next };
+					bucketArray[node->hash % newSize].pushFront(node);
+					node = next;
+				}
+				++migrated;
+				++scanned;
+
+				if ((migrated & BucketArray::CHUNK_MASK) == 0)
+				{
+					oldBuckets.releaseChunk(migrated - 1);
+				}
+			}
+
+			if (migrated == oldSize)
+			{
+				oldBuckets.release();
+				migrated = 0;
+			}
+		}
+
+		size_t migrationBudget() const
+		{
+			size_t count{ nodeArray.size() };
+			size_t growAt{ static_cast<size_t>(MAX_LOAD * bucketArray.size()) };
+			size_t headroom{ growAt > count ? growAt - count : 0 };
+			size_t remaining{ oldBuckets.size() - migrated };
+
+			if (headroom == 0)
+			{
+				return remaining;
+			}
+			return (remaining + headroom - 1) / headroom;
+		}
+
+		void step()
+		{
+			if (rehashing())
+			{
+				migrate(migrationBudget());
+			}
+		}
+
 		void checkLoad()
 		{
+			step();
+
 			double load{ nodeArray.size() / static_cast<double>(bucketArray.size()) };
 			if (load > MAX_LOAD)
 			{
-				rehash(bucketArray.size() * 2);
-			}
-			else if (load < MIN_LOAD)
-			{
-				rehash(bucketArray.size() / 2);
+				beginRehash(bucketArray.size() * 2);
 			}
 		}
 
@@ -2,9 +2,12 @@
 #define B_STAIRVECTOR_H
 
 #include <bit>
+#include <array>
+#include <cstring>
 #include <type_traits>
 #include <algorithm>
 #include <memory>
+#include <utility>
 
 #include "type_traits.h"
 
@@ -17,10 +20,13 @@ namespace ByteC
 		using Pointer = Type*;
 		using Array = Type*;
 		using ContainerData = Array*;
-		using Container = std::unique_ptr<Array[]>;
+
+		inline static constexpr size_t MAX_ARRAYS{ 64 };
+
+		using Container = std::array<Array, MAX_ARRAYS>;
 
 	private:
-		Container arrays{nullptr};
+		Container arrays{};
 		size_t arrayCount{ 0 };
 
 	public:
@@ -35,7 +41,8 @@ namespace ByteC
 
 		ArrayContainer(ArrayContainer&& right) noexcept
 		{
-			arrays = std::move(right.arrays);
+			std::copy(right.arrays.data(), right.arrays.data() + right.arrayCount, arrays.data());
+			arrayCount = right.arrayCount;
 			right.arrayCount = 0;
 		}
 
@@ -43,8 +50,8 @@ namespace ByteC
 
 		ArrayContainer& operator=(ArrayContainer&& right) noexcept
 		{
-			clear();
-			arrays = std::move(right.arrays);
+			std::copy(right.arrays.data(), right.arrays.data() + right.arrayCount, arrays.data());
+			arrayCount = right.arrayCount;
 			right.arrayCount = 0;
 
 			return *this;
@@ -52,29 +59,13 @@ namespace ByteC
 
 		void pushBack(Array newArray)
 		{
-			Container newArrays{ std::make_unique<Array[]>(arrayCount + 1)};
-			if (arrayCount > 0)
-			{
-				std::copy(arrays.get(), arrays.get() + arrayCount, newArrays.get());
-			}
-			newArrays[arrayCount] = newArray;
+			arrays[arrayCount] = newArray;
 			++arrayCount;
-			arrays.swap(newArrays);
 		}
 
 		void popBack()
 		{
 			--arrayCount;
-			if (arrayCount > 0)
-			{
-				Container newArrays{ std::make_unique<Array[]>(arrayCount)};
-				std::copy(arrays.get(), arrays.get() + arrayCount, newArrays.get());
-				arrays.swap(newArrays);
-			}
-			else
-			{
-				arrays.reset();
-			}
 		}
 
 		Array at(size_t index)
@@ -109,12 +100,12 @@ namespace ByteC
 
 		ContainerData data()
 		{
-			return arrays.get();
+			return arrays.data();
 		}
 
-		const ContainerData data() const
+		const Array* data() const
 		{
-			return arrays.get();
+			return arrays.data();
 		}
 	};
 
@@ -123,6 +114,11 @@ namespace ByteC
 		return static_cast<size_t>(std::bit_width(index + 2) - 2);
 	}
 
+	inline size_t getArraySize(size_t arrayIndex)
+	{
+		return 2ULL << arrayIndex;
+	}
+
 	template<typename Type>
 	class StairIterator
 	{
@@ -190,15 +186,24 @@ namespace ByteC
 
 		using Iterator = StairIterator<Type>;
 		using ConstIterator = StairIterator<const Type>;
+
+		inline static constexpr size_t DEFAULT_RETENTION{ 1 };
 	
 	private:
 		Allocator allocator{};
 		ArrayContainer arrays{};
 		size_t itemCount{};
+		size_t retention{ DEFAULT_RETENTION };
+		size_t reserved{};
 
 	public:
 		StairVector() = default;
 
+		StairVector(const Allocator& allocator)
+			:allocator{ allocator }
+		{
+		}
+
 		StairVector(const StairVector& left)
 			:StairVector{ left.copy() }
 		{
@@ -207,7 +212,9 @@ namespace ByteC
 		StairVector(StairVector&& right) noexcept:
 			allocator{std::move(right.allocator)}, 
 			arrays{std::move(right.arrays)}, 
-			itemCount{right.itemCount}
+			itemCount{right.itemCount},
+			retention{right.retention},
+			reserved{right.reserved}
 		{
 			right.itemCount = 0;
 		}
@@ -222,7 +229,21 @@ namespace ByteC
 		StairVector& operator=(StairVector&& right) noexcept
 		{
 			clear();
-			allocator = std::move(right.allocator);
+			releaseArrays(0);
+			retention = right.retention;
+			reserved = right.reserved;
+
+			if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value)
+			{
+				allocator = std::move(right.allocator);
+			}
+			else if (allocator != right.allocator)
+			{
+				pushBack(right, 0, right.itemCount);
+				right.clear();
+				return *this;
+			}
+
 			arrays = std::move(right.arrays);
 			itemCount = right.itemCount;
 			right.itemCount = 0;
@@ -232,18 +253,47 @@ namespace ByteC
 		~StairVector()
 		{
 			clear();
+			releaseArrays(0);
 		}
 
 		void pushBack(const Value& value)
 		{
-			pushBack(Value{ value });
+			emplaceBack(value);
 		}
 
 		void pushBack(Value&& value)
+		{
+			emplaceBack(std::move(value));
+		}
+
+		template<typename... Args>
+		Value& emplaceBack(Args&&... args)
 		{
 			increaseCapacity(itemCount + 1);
-			construct(itemCount, std::move(value));
+			Value& out{ at(itemCount) };
+			AllocatorTraits::construct(allocator, &out, std::forward<Args>(args)...);
 			++itemCount;
+			return out;
+		}
+
+		void pushBack(size_t count, const Value& value)
+		{
+			increaseCapacity(itemCount + count);
+			for (size_t index{ itemCount }; index < itemCount + count; ++index)
+			{
+				AllocatorTraits::construct(allocator, &at(index), value);
+			}
+			itemCount += count;
+		}
+
+		void pushBack(StairVector& source, size_t first, size_t count)
+		{
+			appendRange<true>(source, first, count);
+		}
+
+		void pushBack(const StairVector& source, size_t first, size_t count)
+		{
+			appendRange<false>(source, first, count);
 		}
 
 		void popBack()
@@ -256,6 +306,28 @@ namespace ByteC
 			decreaseCapacity(itemCount);
 		}
 
+		void popBack(size_t count)
+		{
+			if constexpr (!std::is_trivially_destructible<Type>())
+			{
+				for (size_t index{ itemCount - count }; index < itemCount; ++index)
+				{
+					destroy(index);
+				}
+			}
+			itemCount -= count;
+			decreaseCapacity(itemCount);
+		}
+
+		void swapRemove(size_t index)
+		{
+			if (index != itemCount - 1)
+			{
+				at(index) = std::move(back());
+			}
+			popBack();
+		}
+
 		Value& at(size_t index)
 		{
 			size_t arrayIndex{ getArrayIndex(index) };
@@ -323,6 +395,42 @@ namespace ByteC
 			return itemCount == 0;
 		}
 
+		void reserve(size_t newCapacity)
+		{
+			reserved = std::max(reserved, newCapacity);
+			increaseCapacity(newCapacity);
+		}
+
+		void increaseCapacity(size_t newCapacity)
+		{
+			while (capacity() < newCapacity)
+			{
+				arrays.pushBack(AllocatorTraits::allocate(allocator, 2LL << arrays.size()));
+			}
+		}
+
+		void shrinkToFit()
+		{
+			reserved = 0;
+			releaseArrays(getArrayCount(itemCount));
+		}
+
+		void setRetention(size_t newRetention)
+		{
+			retention = newRetention;
+			decreaseCapacity(itemCount);
+		}
+
+		size_t getRetention() const
+		{
+			return retention;
+		}
+
+		Allocator getAllocator() const
+		{
+			return allocator;
+		}
+
 		void clear()
 		{
 			if constexpr (!std::is_trivially_destructible<Type>())
@@ -332,8 +440,8 @@ namespace ByteC
 					destroy(index);
 				}
 			}
-			decreaseCapacity(0);
 			itemCount = 0;
+			decreaseCapacity(0);
 		}
 
 		ArrayContainer& data()
@@ -347,9 +455,56 @@ namespace ByteC
 		}
 		
 	private:
+		template<bool Move, typename Source>
+		void appendRange(Source& source, size_t first, size_t count)
+		{
+			increaseCapacity(itemCount + count);
+
+			while (count > 0)
+			{
+				size_t sourceArray{ getArrayIndex(first) };
+				size_t sourceOffset{ first + 2 - getArraySize(sourceArray) };
+				size_t targetArray{ getArrayIndex(itemCount) };
+				size_t targetOffset{ itemCount + 2 - getArraySize(targetArray) };
+
+				size_t length{ std::min({
+					count,
+					getArraySize(sourceArray) - sourceOffset,
+					getArraySize(targetArray) - targetOffset }) };
+
+				auto from{ source.data().at(sourceArray) + sourceOffset };
+				Array to{ arrays.at(targetArray) + targetOffset };
+
+				if constexpr (std::is_trivially_copyable_v<Type>)
+				{
+					std::memcpy(to, from, length * sizeof(Type));
+				}
+				else
+				{
+					for (size_t index{}; index < length; ++index)
+					{
+						if constexpr (Move)
+						{
+							AllocatorTraits::construct(allocator, to + index, std::move(from[index]));
+						}
+						else
+						{
+							AllocatorTraits::construct(allocator, to + index, from[index]);
+						}
+					}
+				}
+
+				first += length;
+				itemCount += length;
+				count -= length;
+			}
+		}
+
 		StairVector copy() const
 		{
-			StairVector out;
+			StairVector out{ AllocatorTraits::select_on_container_copy_construction(allocator) };
+			out.retention = retention;
+			out.reserved = reserved;
 			out.increaseCapacity(capacity());
 			size_t count{ arrays.size() };
 			for (const Value& value: *this)
@@ -360,38 +515,30 @@ namespace ByteC
 			return out;
 		}
 
-		void construct(size_t index, Value&& value)
-		{
-			AllocatorTraits::construct(allocator, &at(index), std::move(value));
-		}
-
 		void destroy(size_t index)
 		{
 			AllocatorTraits::destroy(allocator, &at(index));
 		}
 
-		void increaseCapacity(size_t newCapacity)
+		void decreaseCapacity(size_t newCapacity)
 		{
-			while (capacity() < newCapacity)
-			{
-				arrays.pushBack(AllocatorTraits::allocate(allocator, 2LL << arrays.size()));
-			}
+			releaseArrays(std::max(getArrayCount(newCapacity) + retention, getArrayCount(reserved)));
 		}
 
-		void decreaseCapacity(size_t newCapacity)
+		void releaseArrays(size_t count)
 		{
-			if (newCapacity)
+			while (arrays.size() > count)
 			{
-				newCapacity += (1ULL << arrays.size());
-			}
-
-			while (capacity() > newCapacity)
-			{
-				AllocatorTraits::deallocate(allocator, arrays.back(), (1ULL << arrays.size()));
+				AllocatorTraits::deallocate(allocator, arrays.back(), getArraySize(arrays.size() - 1));
 				arrays.popBack();
 			}
 		}
 
+		static size_t getArrayCount(size_t count)
+		{
+			return count ? getArrayIndex(count - 1) + 1 : 0;
+		}
+
 	};
 }
 
@@ -1,6 +1,8 @@
 #include <iostream>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
+#include <atomic>
 
 #include "stair_map.h"
 #include "component.h"
@@ -9,8 +11,13 @@
 #include "signature.h"
 #include "pool.h"
 #include "pool_view.h"
+#include "aligned_resource.h"
+#include "flat_map.h"
+#include "command_buffer.h"
+#include "scheduler.h"
 
 #define print(arg) std::cout<<(arg)<<std::endl;
+#define check(condition) if (!(condition)) { std::cerr << "check failed: " << #condition << std::endl; return 1; }
 
 using namespace ByteC;
 using namespace ByteT;
@@ -18,6 +25,47 @@ using namespace ByteE;
 
 #include <chrono>
 
+struct Transform
+{
+	float x;
+	float y;
+	float z;
+};
+
+struct Active
+{
+};
+
+struct Label
+{
+	std::string text;
+};
+
+struct Stun
+{
+	float duration;
+};
+
+struct Burn
+{
+	float duration;
+};
+
+namespace ByteE
+{
+	template<>
+	struct ChangeTracking<Transform>
+	{
+		inline static constexpr bool ROW_TICKS{ true };
+	};
+
+	template<>
+	struct ComponentStorage<Burn>
+	{
+		inline static constexpr bool SPARSE{ true };
+	};
+}
+
 class Timer
 {
 public:
@@ -44,6 +92,131 @@ public:
 	}
 };
 
+template<size_t Index>
+struct Shard
+{
+	float value;
+};
+
+template<size_t... Indices>
+void spawnShards(Pool& pool, std::index_sequence<Indices...>)
+{
+	(pool.createEntities<double, int, Shard<Indices>>(Indices + 1, 0.0, 0, Shard<Indices>{}), ...);
+}
+
+template<typename Map>
+void benchmarkMap(const std::vector<uint64_t>& keys, const std::vector<uint64_t>& lookups)
+{
+	Timer timer;
+	Map map;
+
+	timer.start();
+	for (uint64_t key : keys)
+	{
+		map.insert(key, key);
+	}
+	print(timer.time());
+
+	uint64_t found{};
+	timer.start();
+	for (uint64_t key : lookups)
+	{
+		found += map.find(key).get();
+	}
+	print(timer.time());
+
+	timer.start();
+	for (uint64_t key : lookups)
+	{
+		map.erase(key);
+	}
+	print(timer.time());
+	print(found + map.size());
+}
+
+std::vector<double> getPercentiles(std::vector<double>& samples)
+{
+	std::vector<double> out;
+	std::sort(samples.begin(), samples.end());
+	for (double percentile : { 0.5, 0.99, 0.999, 0.9999, 1.0 })
+	{
+		out.push_back(samples[static_cast<size_t>(percentile * (samples.size() - 1))]);
+	}
+	return out;
+}
+
+template<typename Map>
+class FullRehashMap
+{
+private:
+	Map map;
+
+public:
+	void insert(uint64_t key, uint64_t value)
+	{
+		map.insert(key, value);
+		finishRehash();
+	}
+
+	void erase(uint64_t key)
+	{
+		map.erase(key);
+		finishRehash();
+	}
+
+private:
+	void finishRehash()
+	{
+		if (map.rehashing())
+		{
+			map.rehash(map.tableSize());
+		}
+	}
+};
+
+template<typename Map>
+std::pair<std::vector<double>, std::vector<double>> measureLatency(const std::vector<uint64_t>& keys, const std::vector<uint64_t>& erased)
+{
+	Map map;
+	std::vector<double> samples;
+	samples.reserve(keys.size());
+
+	for (uint64_t key : keys)
+	{
+		auto start{ std::chrono::steady_clock::now() };
+		map.insert(key, key);
+		std::chrono::duration<double, std::micro> duration{ std::chrono::steady_clock::now() - start };
+		samples.push_back(duration.count());
+	}
+	std::vector<double> inserts{ getPercentiles(samples) };
+
+	samples.clear();
+	for (uint64_t key : erased)
+	{
+		auto start{ std::chrono::steady_clock::now() };
+		map.erase(key);
+		std::chrono::duration<double, std::micro> duration{ std::chrono::steady_clock::now() - start };
+		samples.push_back(duration.count());
+	}
+	return { inserts, getPercentiles(samples) };
+}
+
+template<typename Map>
+void benchmarkLatency(const std::vector<uint64_t>& keys, const std::vector<uint64_t>& erased)
+{
+	auto [incrementalInserts, incrementalErases] { measureLatency<Map>(keys, erased) };
+	auto [fullInserts, fullErases] { measureLatency<FullRehashMap<Map>>(keys, erased) };
+
+	for (size_t i{}; i < incrementalInserts.size(); ++i)
+	{
+		std::cout << incrementalInserts[i] << ' ' << fullInserts[i] << std::endl;
+	}
+	for (size_t i{}; i < incrementalErases.size(); ++i)
+	{
+		std::cout << incrementalErases[i] << ' ' << fullErases[i] << std::endl;
+	}
+}
+
 int main()
 {
 	Timer timer;
@@ -58,6 +231,11 @@ int main()
 	}
 	print(timer.time());
 
+	Pool bulkPool;
+	timer.start();
+	bulkPool.createEntities<double, float>(1000000, 1.0, 1.0f);
+	print(timer.time());
+
 	timer.start();
 	for (size_t i{ 1 }; i < 1E6 + 1; ++i)
 	{
@@ -68,7 +246,7 @@ int main()
 	timer.start();
 	for (size_t i{ 1 }; i < 1E6 + 1; ++i)
 	{
-		pool.addComponent<bool>(i, 1);
+		pool.addComponent(i, Active{});
 	}
 	print(timer.time());
 
@@ -76,18 +254,353 @@ int main()
 	timer.start();
 	for (size_t i{ 1 }; i < 1E6 + 1; ++i)
 	{
-		sum += pool.getComponent<float>(i);
+		sum += pool.getComponent<const float>(i);
 	}
 	print(timer.time());
 
-	PoolView<float> poolView{pool};
+	PoolView<const float> poolView{pool};
 	timer.start();
 	for (auto [id,i]:poolView)
 	{
 		sum += i;
 	}
 	print(timer.time());
+
+	timer.start();
+	poolView.forEachChunk([&sum](size_t count, EntityID*, const float* values)
+	{
+		float chunkSum{};
+		for (size_t i{}; i < count; ++i)
+		{
+			chunkSum += values[i];
+		}
+		sum += chunkSum;
+	});
+	print(timer.time());
 	print(sum);
 
+	float activeSum{};
+	PoolView<const float, const Active>{ pool }.forEachChunk([&activeSum](size_t count, EntityID*, const float* values)
+	{
+		for (size_t i{}; i < count; ++i)
+		{
+			activeSum += values[i];
+		}
+	});
+	print(activeSum);
+
+	Pool stalePool;
+	EntityID stale{ stalePool.createEntity() };
+	stalePool.destroyEntity(stale);
+	EntityID reused{ stalePool.createEntity() };
+	stalePool.addComponent(stale, 1.0f);
+	check(!stalePool.hasComponent<float>(stale) && !stalePool.hasComponent<float>(reused));
+
+	Pool parallelPool;
+	spawnShards(parallelPool, std::make_index_sequence<64>{});
+	parallelPool.createEntities<double, int>(4000000, 0.0, 0);
+
+	double serialSum{};
+	PoolView<double>{ parallelPool }.forEachChunk([&serialSum](size_t count, EntityID*, double* values)
+	{
+		for (size_t i{}; i < count; ++i)
+		{
+			values[i] = serialSum;
+			serialSum += 1.0;
+		}
+	});
+	serialSum = serialSum * (serialSum - 1.0) / 2.0;
+
+	PoolView<int> visitView{ parallelPool };
+	ThreadPool visitThreads{ 4 };
+	for (size_t grain : { PoolView<int>::PARALLEL_GRAIN, size_t{ 1000 }, size_t{ 7 } })
+	{
+		visitView.parallelForEach(visitThreads, [](EntityID, int& visits)
+		{
+			++visits;
+		}, grain);
+	}
+
+	size_t badVisits{};
+	PoolView<const int>{ parallelPool }.forEachChunk([&badVisits](size_t count, EntityID*, const int* visits)
+	{
+		for (size_t i{}; i < count; ++i)
+		{
+			badVisits += visits[i] != 3;
+		}
+	});
+	check(badVisits == 0);
+
+	PoolView<const double> parallelView{ parallelPool };
+	for (size_t threadCount : { 1, 2, 4, 8 })
+	{
+		ThreadPool threads{ threadCount };
+		std::atomic<uint64_t> parallelSum{};
+
+		timer.start();
+		parallelView.parallelForEachChunk(threads, [&parallelSum](size_t count, EntityID*, const double* values)
+		{
+			uint64_t chunkSum{};
+			for (size_t i{}; i < count; ++i)
+			{
+				chunkSum += static_cast<uint64_t>(values[i]);
+			}
+			parallelSum += chunkSum;
+		});
+		print(timer.time());
+		check(parallelSum == static_cast<uint64_t>(serialSum));
+	}
+
+	Pool schedulePool;
+	schedulePool.createEntities<Transform, double>(1000, Transform{}, 1.0);
+
+	size_t activeDuringMove{};
+	size_t activeAfterMove{};
+	float movedSum{};
+	double speedSum{};
+
+	Scheduler scheduler;
+	scheduler.addSystem<Read<double>, Write<Transform>>([](PoolView<const double, Transform>& view, CommandBuffer& commands)
+	{
+		for (auto [id, speed, transform] : view)
+		{
+			transform.x += static_cast<float>(speed);
+			commands.addComponent(id, Active{});
+		}
+	});
+	scheduler.addSystem<Read<Active>, Write<>>([&activeDuringMove](PoolView<const Active>& view, CommandBuffer&)
+	{
+		for ([[maybe_unused]] auto [id, active] : view)
+		{
+			++activeDuringMove;
+		}
+	});
+	scheduler.addSystem<Read<Transform, Active>, Write<>>([&activeAfterMove, &movedSum](PoolView<const Transform, const Active>& view, CommandBuffer&)
+	{
+		for (auto [id, transform, active] : view)
+		{
+			++activeAfterMove;
+			movedSum += transform.x;
+		}
+	});
+	scheduler.addSystem<Read<>, Write<double>>([](PoolView<double>& view, CommandBuffer&)
+	{
+		for (auto [id, speed] : view)
+		{
+			speed = 2.0;
+		}
+	});
+	scheduler.addSystem<Read<double>, Write<>>([&speedSum](PoolView<const double>& view, CommandBuffer&)
+	{
+		for (auto [id, speed] : view)
+		{
+			speedSum += speed;
+		}
+	});
+	scheduler.run(schedulePool);
+
+	check(scheduler.stageCount() == 3);
+	check(activeDuringMove == 0);
+	check(activeAfterMove == 1000);
+	check(movedSum == 1000.0f);
+	check(speedSum == 2000.0);
+
+	Pool evictPool;
+	evictPool.setClusterRetention(1);
+	EntityID matched{ evictPool.createEntity() };
+	evictPool.addComponent(matched, 1.0f);
+	EntityID bystander{ evictPool.createEntity() };
+	evictPool.addComponent(bystander, 1.0);
+	EntityID transient{ evictPool.createEntity() };
+	evictPool.addComponents(transient, 1.0f, 1.0);
+	evictPool.destroyEntity(transient);
+	evictPool.destroyAll<float>();
+	check(!evictPool.contains(matched) && evictPool.contains(bystander));
+
+	Pool overlapPool;
+	EntityID first{ overlapPool.createEntity() };
+	EntityID second{ overlapPool.createEntity() };
+	overlapPool.addComponents(first, 1.0f, 1.0);
+	overlapPool.addComponents(second, 2.0f, 1.0);
+	overlapPool.addComponents<float>(first, 10.0f);
+	EntityID third{ overlapPool.createEntity() };
+	overlapPool.addComponents(third, 30.0f, 1.0);
+	check(overlapPool.getComponent<float>(first) + overlapPool.getComponent<float>(third) == 40.0f);
+
+	Pool aliasPool;
+	EntityID named{ aliasPool.createEntity() };
+	aliasPool.addComponent(named, std::string(64, 'a'));
+	aliasPool.emplaceComponent<Label>(named, aliasPool.getComponent<const std::string>(named));
+	EntityID renamed{ aliasPool.createEntity() };
+	aliasPool.addComponent(renamed, std::string(64, 'b'));
+	aliasPool.emplaceComponents<float, Label>(renamed, std::forward_as_tuple(1.0f), std::forward_as_tuple(aliasPool.getComponent<const std::string>(renamed)));
+	check(aliasPool.getComponent<const Label>(named).text.size() + aliasPool.getComponent<const Label>(renamed).text.size() == 128);
+
+	AlignedResource alignedResource;
+	Pool defaultPool;
+	Pool alignedPool{ &alignedResource };
+	defaultPool.createEntities<double, float>(8000000, 1.0, 1.0f);
+	alignedPool.createEntities<double, float>(8000000, 1.0, 1.0f);
+
+	double sweepSum{};
+	auto sweep{ [&sweepSum](size_t count, EntityID*, const double* values)
+	{
+		double chunkSum{};
+		for (size_t i{}; i < count; ++i)
+		{
+			chunkSum += values[i];
+		}
+		sweepSum += chunkSum;
+	} };
+
+	PoolView<const double> defaultView{ defaultPool };
+	timer.start();
+	defaultView.forEachChunk(sweep);
+	print(timer.time());
+
+	PoolView<const double> alignedView{ alignedPool };
+	timer.start();
+	alignedView.forEachChunk(sweep);
+	print(timer.time());
+	print(sweepSum);
+
+	Pool syncPool;
+	std::vector<EntityID> synced{ syncPool.createEntities<Transform>(1000000, Transform{}) };
+	Tick lastSync{ syncPool.getTick() };
+	syncPool.advanceTick();
+	for (size_t i{}; i < synced.size(); i += 20)
+	{
+		syncPool.getComponent<Transform>(synced[i]).x += 1.0f;
+	}
+
+	auto sync{ [](PoolView<Changed<Transform>> view)
+	{
+		float syncSum{};
+		view.forEachChunk([&syncSum](size_t count, EntityID*, const Transform* transforms)
+		{
+			for (size_t i{}; i < count; ++i)
+			{
+				syncSum += transforms[i].x;
+			}
+		});
+		return syncSum;
+	} };
+
+	timer.start();
+	float fullSync{ sync(PoolView<Changed<Transform>>{ syncPool }) };
+	print(timer.time());
+
+	timer.start();
+	float changedSync{ sync(PoolView<Changed<Transform>>{ syncPool, lastSync }) };
+	print(timer.time());
+	print(fullSync + changedSync);
+
+	Pool localPool;
+	std::vector<EntityID> localized{ localPool.createEntities<Transform>(1000000, Transform{}) };
+	Tick lastLocal{ localPool.getTick() };
+	localPool.advanceTick();
+	for (size_t i{}; i < localized.size() / 20; ++i)
+	{
+		localPool.getComponent<Transform>(localized[i]).x += 1.0f;
+	}
+
+	timer.start();
+	float fullLocal{ sync(PoolView<Changed<Transform>>{ localPool }) };
+	print(timer.time());
+
+	timer.start();
+	float changedLocal{ sync(PoolView<Changed<Transform>>{ localPool, lastLocal }) };
+	print(timer.time());
+	check(fullLocal == 50000.0f && changedLocal == 50000.0f);
+
+	Pool refPool;
+	EntityID held{ refPool.createEntity() };
+	refPool.addComponent(held, Transform{ 3.0f, 0.0f, 0.0f });
+	Tick beforeRead{ refPool.getTick() };
+	refPool.advanceTick();
+	EntityRef heldRef{ refPool.ref(held) };
+	check(heldRef.has<const Transform>());
+	check(heldRef.get<const Transform>().x == 3.0f);
+	check(sync(PoolView<Changed<Transform>>{ refPool, beforeRead }) == 0.0f);
+
+	Pool bufferedPool;
+	EntityID buffered{ bufferedPool.createEntity() };
+	EntityID unclustered{ bufferedPool.createEntity() };
+	bufferedPool.addComponent(buffered, 1.0);
+	Tick beforeFlush{ bufferedPool.getTick() };
+	bufferedPool.advanceTick();
+	CommandBuffer commands;
+	commands.addComponent(buffered, Transform{ 1.0f, 0.0f, 0.0f });
+	commands.addComponent(unclustered, Transform{ 2.0f, 0.0f, 0.0f });
+	commands.flush(bufferedPool);
+	check(sync(PoolView<Changed<Transform>>{ bufferedPool, beforeFlush }) == 3.0f);
+
+	Pool churnPool;
+	std::vector<EntityID> afflicted{ churnPool.createEntities<Transform, double, int>(100000, Transform{}, 0.0, 0) };
+
+	timer.start();
+	for (size_t round{}; round < 10; ++round)
+	{
+		for (EntityID id : afflicted)
+		{
+			churnPool.addComponent(id, Stun{ 1.0f });
+		}
+		for (EntityID id : afflicted)
+		{
+			churnPool.removeComponent<Stun>(id);
+		}
+	}
+	print(timer.time());
+
+	timer.start();
+	for (size_t round{}; round < 10; ++round)
+	{
+		for (EntityID id : afflicted)
+		{
+			churnPool.addComponent(id, Burn{ 1.0f });
+		}
+		for (EntityID id : afflicted)
+		{
+			churnPool.removeComponent<Burn>(id);
+		}
+	}
+	print(timer.time());
+
+	for (size_t i{}; i < afflicted.size(); i += 10)
+	{
+		churnPool.addComponent(afflicted[i], Burn{ 2.0f });
+	}
+
+	float burnSum{};
+	timer.start();
+	for (auto [id, transform, burn] : PoolView<const Transform, const Burn>{ churnPool })
+	{
+		burnSum += burn.duration;
+	}
+	print(timer.time());
+	print(burnSum);
+
+	for (size_t keyCount : { 1000000ULL, 10000000ULL })
+	{
+		std::vector<uint64_t> keys(keyCount);
+		uint64_t state{ 0x9e3779b97f4a7c15ULL };
+		for (uint64_t& key : keys)
+		{
+			state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+			key = ByteA::mix(state);
+		}
+
+		std::vector<uint64_t> lookups{ keys };
+		for (size_t i{ lookups.size() - 1 }; i > 0; --i)
+		{
+			state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+			std::swap(lookups[i], lookups[(state >> 33) % (i + 1)]);
+		}
+
+		benchmarkMap<StairMap<uint64_t, uint64_t>>(keys, lookups);
+		benchmarkMap<FlatMap<uint64_t, uint64_t>>(keys, lookups);
+		benchmarkLatency<StairMap<uint64_t, uint64_t>>(keys, lookups);
+	}
+
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,235 @@
+#ifndef B_THREADPOOL_H
+#define B_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ByteE
+{
+
+	class ThreadPool
+	{
+	public:
+		using Task = std::function<void()>;
+
+		struct WorkQueue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		using QueueContainer = std::vector<std::unique_ptr<WorkQueue>>;
+		using ThreadContainer = std::vector<std::thread>;
+
+		inline static constexpr size_t NO_WORKER{ static_cast<size_t>(-1) };
+
+	private:
+		QueueContainer queues;
+		ThreadContainer threads;
+
+		std::atomic<size_t> pending{};
+		std::atomic<size_t> nextQueue{};
+		std::atomic<bool> running{ true };
+
+		std::mutex sleepMutex;
+		std::condition_variable wake;
+
+		inline static thread_local ThreadPool* currentPool{ nullptr };
+		inline static thread_local size_t currentWorker{ NO_WORKER };
+
+	public:
+		ThreadPool(size_t threadCount = std::thread::hardware_concurrency())
+		{
+			threadCount = std::max<size_t>(threadCount, 1);
+
+			for (size_t index{}; index < threadCount; ++index)
+			{
+				queues.push_back(std::make_unique<WorkQueue>());
+			}
+
+			for (size_t index{}; index < threadCount; ++index)
+			{
+				threads.emplace_back([this, index]() { work(index); });
+			}
+		}
+
+		ThreadPool(const ThreadPool& left) = delete;
+
+		ThreadPool& operator=(const ThreadPool& left) = delete;
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock{ sleepMutex };
+				running = false;
+			}
+			wake.notify_all();
+
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+		}
+
+		void submit(Task task)
+		{
+			size_t queueIndex{ currentPool == this ? currentWorker : nextQueue++ % queues.size() };
+			WorkQueue& queue{ *queues[queueIndex] };
+			{
+				std::lock_guard<std::mutex> lock{ queue.mutex };
+				if (currentPool == this)
+				{
+					queue.tasks.push_front(std::move(task));
+				}
+				else
+				{
+					queue.tasks.push_back(std::move(task));
+				}
+			}
+
+			++pending;
+			{
+				std::lock_guard<std::mutex> lock{ sleepMutex };
+			}
+			wake.notify_one();
+		}
+
+		bool runPending()
+		{
+			Task task;
+			if (!take(currentPool == this ? currentWorker : 0, task))
+			{
+				return false;
+			}
+			task();
+			return true;
+		}
+
+		size_t size() const
+		{
+			return threads.size();
+		}
+
+		static ThreadPool& global()
+		{
+			static ThreadPool pool;
+			return pool;
+		}
+
+	private:
+		void work(size_t index)
+		{
+			currentPool = this;
+			currentWorker = index;
+
+			while (running)
+			{
+				Task task;
+				if (take(index, task))
+				{
+					task();
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock{ sleepMutex };
+				wake.wait(lock, [this]() { return pending > 0 || !running; });
+			}
+		}
+
+		bool take(size_t home, Task& task)
+		{
+			if (pending == 0)
+			{
+				return false;
+			}
+
+			for (size_t offset{}; offset < queues.size(); ++offset)
+			{
+				WorkQueue& queue{ *queues[(home + offset) % queues.size()] };
+				std::lock_guard<std::mutex> lock{ queue.mutex };
+
+				if (queue.tasks.empty())
+				{
+					continue;
+				}
+
+				if (offset == 0)
+				{
+					task = std::move(queue.tasks.front());
+					queue.tasks.pop_front();
+				}
+				else
+				{
+					task = std::move(queue.tasks.back());
+					queue.tasks.pop_back();
+				}
+
+				--pending;
+				return true;
+			}
+
+			return false;
+		}
+	};
+
+	class TaskGroup
+	{
+	public:
+		using Task = ThreadPool::Task;
+
+	private:
+		ThreadPool* threads;
+		std::atomic<size_t> remaining{};
+		std::mutex mutex;
+		std::condition_variable done;
+
+	public:
+		TaskGroup(ThreadPool& threads)
+			:threads{ &threads }
+		{
+		}
+
+		TaskGroup(const TaskGroup& left) = delete;
+
+		TaskGroup& operator=(const TaskGroup& left) = delete;
+
+		~TaskGroup()
+		{
+			wait();
+		}
+
+		void run(Task task)
+		{
+			++remaining;
+			threads->submit([this, task{ std::move(task) }]()
+			{
+				task();
+				std::lock_guard<std::mutex> lock{ mutex };
+				if (--remaining == 0)
+				{
+					done.notify_all();
+				}
+			});
+		}
+
+		void wait()
+		{
+			while (remaining > 0 && threads->runPending())
+			{
+			}
+
+			std::unique_lock<std::mutex> lock{ mutex };
+			done.wait(lock, [this]() { return remaining == 0; });
+		}
+	};
+
+}
+
+#endif
\ No newline at end of file